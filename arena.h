@@ -0,0 +1,109 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+using namespace std;
+
+// 区域（bump）分配器：从大块内存中顺序切出对象，不单独释放。
+// 一次分析产生的语法树节点、子节点数组和节点字符串都放在这里，
+// 分析结束后整体释放，释放代价只与块数有关，与节点数无关。
+// 只能存放可平凡析构的类型，析构函数不会被调用
+class Arena {
+private:
+    struct Block {
+        Block* next;  // 更早分配的块
+        size_t size;  // 数据区大小
+    };
+
+    Block* head = nullptr; // 当前块
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t blockSize;
+
+    // 分配一个至少能容纳 size 字节（按 align 对齐）的新块。
+    // 数据区大小取 max_align_t 的整数倍，块末尾总是对齐的
+    void grow(size_t size, size_t align) {
+        size_t need = size + align;
+        size_t dataSize = need > blockSize ? need : blockSize;
+        dataSize = (dataSize + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+        Block* block = (Block*)malloc(sizeof(Block) + dataSize);
+        if (!block) throw bad_alloc();
+        block->next = head;
+        block->size = dataSize;
+        head = block;
+        cursor = (char*)(block + 1);
+        limit = cursor + dataSize;
+        if (blockSize < MAX_BLOCK_SIZE) blockSize *= 2; // 输入越大块越大，块数按对数增长
+    }
+
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 << 10;
+    static constexpr size_t MAX_BLOCK_SIZE = 16 << 20;
+
+    explicit Arena(size_t initialBlockSize = DEFAULT_BLOCK_SIZE) : blockSize(initialBlockSize) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        while (head) {
+            Block* next = head->next;
+            free(head);
+            head = next;
+        }
+    }
+
+    void* allocate(size_t size, size_t align = alignof(max_align_t)) {
+        char* p = (char*)(((uintptr_t)cursor + (align - 1)) & ~(uintptr_t)(align - 1));
+        // 对齐后 p 可能越过 limit（块里只剩不到 align 字节），这时 limit - p 是负数
+        if (!head || p > limit || size > (size_t)(limit - p)) {
+            grow(size, align);
+            p = (char*)(((uintptr_t)cursor + (align - 1)) & ~(uintptr_t)(align - 1));
+        }
+        cursor = p + size;
+        return p;
+    }
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        static_assert(is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+    }
+
+    template <typename T>
+    T* allocateArray(size_t count) {
+        static_assert(is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        return (T*)allocate(sizeof(T) * count, alignof(T));
+    }
+
+    // 把字符串复制进区域，返回指向副本的切片
+    string_view copy(string_view text) {
+        if (text.empty()) return string_view();
+        char* p = (char*)allocate(text.size(), 1);
+        memcpy(p, text.data(), text.size());
+        return string_view(p, text.size());
+    }
+
+    // 释放全部内容，保留最后（最大）的一块供下一次分析复用
+    void reset() {
+        if (!head) return;
+        Block* keep = head;
+        Block* block = head->next;
+        while (block) {
+            Block* next = block->next;
+            free(block);
+            block = next;
+        }
+        keep->next = nullptr;
+        cursor = (char*)(keep + 1);
+        limit = cursor + keep->size;
+    }
+};
+
+#endif // ARENA_H
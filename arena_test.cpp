@@ -0,0 +1,52 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "arena.h"
+using namespace std;
+
+// 区域分配器的回归测试：分配的内存必须按要求对齐并完全落在块内。
+// 用 -fsanitize=address 编译时越界写会直接报错
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+// 超大的不对齐复制之后紧接着对齐分配：块末尾不对齐时，对齐后的位置会越过块末尾
+static void oversizedCopyThenAligned() {
+    Arena arena(64);
+    string text(67, 'x');
+    string_view copy = arena.copy(text);
+    check(copy == text, "oversized copy keeps its content");
+    void* p = arena.allocate(16, 16);
+    check((uintptr_t)p % 16 == 0, "aligned allocation after an oversized copy");
+    memset(p, 0, 16);
+    check(copy == text, "aligned allocation does not overlap the copy");
+}
+
+// 各种大小的复制与对齐分配交替进行，写满每一块分配到的内存
+static void mixedAllocations() {
+    Arena arena(32);
+    for (size_t i = 1; i < 2000; ++i) {
+        string text(i % 97 + 1, (char)('a' + i % 26));
+        string_view copy = arena.copy(text);
+        size_t align = (size_t)1 << (i % 5);
+        size_t size = i % 41 + 1;
+        char* p = (char*)arena.allocate(size, align);
+        check((uintptr_t)p % align == 0, "allocation is aligned");
+        memset(p, 0xAB, size);
+        check(copy == text, "earlier copy is not overwritten");
+    }
+}
+
+int main() {
+    oversizedCopyThenAligned();
+    mixedAllocations();
+    if (failures) return 1;
+    printf("arena ok\n");
+    return 0;
+}
@@ -0,0 +1,286 @@
+#ifndef AST_H
+#define AST_H
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include "arena.h"
+#include "interner.h"
+#include "lexer.h"
+using namespace std;
+
+// 语法树节点类型
+enum NodeType {
+    NODE_EXPR,    // 表达式
+    NODE_BOOL,    // 布尔表达式
+    NODE_DECLS,   // 声明语句
+    NODE_STMTS,   // 执行语句
+    NODE_ASSIGN,  // 赋值语句
+    NODE_IF,      // if语句
+    NODE_WHILE,   // while语句
+    NODE_FOR,     // for语句
+    NODE_READ,    // read语句
+    NODE_WRITE,   // write语句
+    NODE_BLOCK,   // 语句块
+    NODE_OP,      // 运算符
+    NODE_ID,      // 标识符
+    NODE_NUM,     // 数字常量
+    NODE_FLOAT,   // 浮点数常量
+    NODE_BOOLVAL, // 布尔值
+    NODE_TYPE,    // 类型
+    NODE_LIST,    // 列表
+    NODE_NONE     // 空位（如 for 语句省略的部分），不输出
+};
+
+// 节点类型转字符串
+inline const char* nodeTypeToString(NodeType type) {
+    switch (type) {
+    case NODE_EXPR:    return "EXPR";
+    case NODE_BOOL:    return "BOOL";
+    case NODE_DECLS:   return "DECLS";
+    case NODE_STMTS:   return "STMTS";
+    case NODE_ASSIGN:  return "ASSIGN";
+    case NODE_IF:      return "IF";
+    case NODE_WHILE:   return "WHILE";
+    case NODE_FOR:     return "FOR";
+    case NODE_READ:    return "READ";
+    case NODE_WRITE:   return "WRITE";
+    case NODE_BLOCK:   return "BLOCK";
+    case NODE_OP:      return "OP";
+    case NODE_ID:      return "ID";
+    case NODE_NUM:     return "NUM";
+    case NODE_FLOAT:   return "FLOAT";
+    case NODE_BOOLVAL: return "BOOLVAL";
+    case NODE_TYPE:    return "TYPE";
+    case NODE_LIST:    return "LIST";
+    default:           return "UNKNOWN";
+    }
+}
+
+// 语法分析器通过下面两种语法树之一构造结果，二者接口相同：
+//   Node                      节点句柄，NONE 表示空位
+//   newNode(type, value)      创建节点
+//   newSymbolNode(type, id)   用驻留表中的编号创建节点（标识符）
+//   newLiteralNode(type, id, literal)  创建常数节点，同时保存转换好的值
+//   intern(text)              把拼写驻留进本次会话的驻留表
+//   addChild(parent, child)   追加子节点（child 可以是 NONE）
+//   type(n) / value(n)        读取节点
+//   literal(n)                常数节点的值（NODE_NUM 用 i，NODE_FLOAT 用 f）
+//   valueId(n)                标识符和常数节点的驻留编号，拼写相同编号相同
+//   forEachChild(n, f)        按顺序访问子节点，空位也会访问到
+
+struct TreeNode;
+
+// 子节点数组，存放在 Arena 中，随语法树一起整体释放
+struct NodeList {
+    TreeNode** items = nullptr;
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+
+    TreeNode** begin() const { return items; }
+    TreeNode** end() const { return items + count; }
+    size_t size() const { return count; }
+    TreeNode* operator[](size_t i) const { return items[i]; }
+};
+
+// 指针树的节点，节点、子节点数组和值都分配在 Arena 中，没有析构函数
+struct TreeNode {
+    NodeType type;
+    uint32_t symbol = 0; // 标识符和常数的驻留编号
+    string_view value;
+    NodeList children;
+    Literal literal = {}; // 常数的值，仅 NODE_NUM / NODE_FLOAT 使用
+
+    TreeNode(NodeType t, string_view v = "") : type(t), value(v) {}
+};
+
+// 指针树：每个节点一个 TreeNode，子节点是指针数组。便于就地改写，
+// 节点约 48 字节，另加子节点数组和值的副本
+class PointerTree {
+private:
+    Arena arena; // 整棵树的存储，随 PointerTree 一起释放
+    StringInterner& symbols; // 本次会话的驻留表，由调用方持有
+
+public:
+    using Node = TreeNode*;
+    static constexpr Node NONE = nullptr;
+
+    explicit PointerTree(StringInterner& table) : symbols(table) {}
+
+    // 创建节点，值复制进 Arena，语法树不再引用单词符号的缓冲区
+    Node newNode(NodeType type, string_view value = "") {
+        return arena.create<TreeNode>(type, arena.copy(value));
+    }
+
+    // 值直接引用驻留表中的字符串，同名节点共用一份
+    Node newSymbolNode(NodeType type, uint32_t symbol) {
+        Node node = arena.create<TreeNode>(type, symbols[symbol]);
+        node->symbol = symbol;
+        return node;
+    }
+
+    Node newLiteralNode(NodeType type, uint32_t symbol, Literal literal) {
+        Node node = newSymbolNode(type, symbol);
+        node->literal = literal;
+        return node;
+    }
+
+    uint32_t intern(string_view text) {
+        return symbols.intern(text);
+    }
+
+    // 追加子节点，数组满时在 Arena 中按两倍容量重新分配（旧数组随 Arena 一起释放）
+    void addChild(Node node, Node child) {
+        NodeList& list = node->children;
+        if (list.count == list.capacity) {
+            uint32_t capacity = list.capacity ? list.capacity * 2 : 2;
+            TreeNode** items = arena.allocateArray<TreeNode*>(capacity);
+            if (list.count) memcpy(items, list.items, list.count * sizeof(TreeNode*));
+            list.items = items;
+            list.capacity = capacity;
+        }
+        list.items[list.count++] = child;
+    }
+
+    NodeType type(Node node) const {
+        return node ? node->type : NODE_NONE;
+    }
+
+    string_view value(Node node) const {
+        return node->value;
+    }
+
+    Literal literal(Node node) const {
+        return node->literal;
+    }
+
+    // 标识符和常数节点的驻留编号，其他节点为 0
+    uint32_t valueId(Node node) const {
+        return node->symbol;
+    }
+
+    template <typename Visit>
+    void forEachChild(Node node, Visit visit) const {
+        for (TreeNode* child : node->children) visit(child);
+    }
+};
+
+// 扁平语法树：节点按创建顺序存放在几个并列的数组里（结构数组），用 32 位下标互相引用。
+// 子节点用"第一个子节点 + 下一个兄弟"串起来，值驻留在字符串表中只存编号。
+// 每个节点 17 字节，没有逐节点的堆分配，遍历时顺序访问连续内存
+class FlatTree {
+public:
+    using Node = uint32_t;
+    static constexpr Node NONE = UINT32_MAX;
+
+private:
+    vector<unsigned char> types;  // NodeType
+    vector<Node> firstChildren;   // 第一个子节点，没有时为 NONE
+    vector<Node> nextSiblings;    // 下一个兄弟节点，没有时为 NONE
+    vector<Node> lastChildren;    // 最后一个子节点，追加子节点时使用
+    vector<uint32_t> values;      // 值在 strings 中的编号
+    vector<Literal> literals;     // 驻留编号 -> 常数的值，拼写相同的常数只存一份
+    StringInterner& strings;      // 本次会话的驻留表，与词法分析器共用，由调用方持有
+
+public:
+    explicit FlatTree(StringInterner& table) : strings(table) {}
+
+    Node newNode(NodeType type, string_view value = "") {
+        return newSymbolNode(type, strings.intern(value));
+    }
+
+    Node newSymbolNode(NodeType type, uint32_t symbol) {
+        Node node = (Node)types.size();
+        types.push_back((unsigned char)type);
+        firstChildren.push_back(NONE);
+        nextSiblings.push_back(NONE);
+        lastChildren.push_back(NONE);
+        values.push_back(symbol);
+        return node;
+    }
+
+    Node newLiteralNode(NodeType type, uint32_t symbol, Literal literal) {
+        if (symbol >= literals.size()) literals.resize(symbol + 1);
+        literals[symbol] = literal;
+        return newSymbolNode(type, symbol);
+    }
+
+    uint32_t intern(string_view text) {
+        return strings.intern(text);
+    }
+
+    // 空位也占一个 NODE_NONE 节点，保持子节点的位置
+    void addChild(Node node, Node child) {
+        if (child == NONE) child = newNode(NODE_NONE);
+        if (lastChildren[node] == NONE) {
+            firstChildren[node] = child;
+        } else {
+            nextSiblings[lastChildren[node]] = child;
+        }
+        lastChildren[node] = child;
+    }
+
+    NodeType type(Node node) const {
+        return node == NONE ? NODE_NONE : (NodeType)types[node];
+    }
+
+    string_view value(Node node) const {
+        return strings[values[node]];
+    }
+
+    Literal literal(Node node) const {
+        return literals[values[node]];
+    }
+
+    // 值在字符串表中的编号，拼写相同的值编号相同
+    uint32_t valueId(Node node) const {
+        return values[node];
+    }
+
+    Node firstChild(Node node) const {
+        return firstChildren[node];
+    }
+
+    Node nextSibling(Node node) const {
+        return nextSiblings[node];
+    }
+
+    template <typename Visit>
+    void forEachChild(Node node, Visit visit) const {
+        for (Node child = firstChildren[node]; child != NONE; child = nextSiblings[child]) {
+            visit((NodeType)types[child] == NODE_NONE ? NONE : child);
+        }
+    }
+
+    size_t size() const {
+        return types.size();
+    }
+};
+
+// 按缩进格式打印语法树，每个节点一行 "[类型] 值"，空位不输出
+template <typename Tree>
+void printTree(const Tree& tree, typename Tree::Node node, ostream& out, int depth = 0) {
+    if (tree.type(node) == NODE_NONE) return;
+
+    // 缩进
+    for (int i = 0; i < depth; ++i) {
+        out << "  ";
+    }
+
+    // 打印节点类型和值
+    out << "[" << nodeTypeToString(tree.type(node)) << "]";
+    string_view value = tree.value(node);
+    if (!value.empty()) {
+        out << " " << value;
+    }
+    out << '\n';
+
+    // 打印子节点
+    tree.forEachChild(node, [&](typename Tree::Node child) {
+        printTree(tree, child, out, depth + 1);
+    });
+}
+
+#endif // AST_H
@@ -0,0 +1,148 @@
+#ifndef BUFFERED_IO_H
+#define BUFFERED_IO_H
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+// 程序 read 语句的输入：按块 fread 到缓冲区，按空白切分单词后用 from_chars 转换，
+// 不经过 iostream，也不逐字符调用 getc
+class BufferedInput {
+private:
+    FILE* file;
+    vector<char> buffer;
+    size_t begin = 0; // 未读部分 [begin, end)
+    size_t end = 0;
+    bool eof = false;
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+    }
+
+    // 把未读部分移到缓冲区开头并接着读入，缓冲区已满时加倍
+    void refill() {
+        if (begin > 0) {
+            memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+        if (end == buffer.size()) buffer.resize(buffer.size() * 2);
+        size_t n = fread(buffer.data() + end, 1, buffer.size() - end, file);
+        end += n;
+        if (n == 0) eof = true;
+    }
+
+public:
+    explicit BufferedInput(FILE* f, size_t size = 1 << 16) : file(f), buffer(size) {}
+
+    // 读下一个以空白分隔的单词，输入结束时返回 false。
+    // word 指向内部缓冲区，下一次读取后失效
+    bool next(string_view& word) {
+        while (true) {
+            while (begin < end && isSpace(buffer[begin])) ++begin;
+            if (begin == end) {
+                if (eof) return false;
+                refill();
+                continue;
+            }
+            size_t p = begin;
+            while (p < end && !isSpace(buffer[p])) ++p;
+            if (p == end && !eof) {
+                refill(); // 单词可能延续到下一块
+                continue;
+            }
+            word = string_view(buffer.data() + begin, p - begin);
+            begin = p;
+            return true;
+        }
+    }
+
+    bool readInt(int64_t& value) {
+        string_view word;
+        if (!next(word)) return false;
+        const char* last = word.data() + word.size();
+        from_chars_result result = from_chars(word.data(), last, value);
+        return result.ec == errc() && result.ptr == last;
+    }
+
+    bool readFloat(double& value) {
+        string_view word;
+        if (!next(word)) return false;
+        const char* last = word.data() + word.size();
+        from_chars_result result = from_chars(word.data(), last, value);
+        return result.ec == errc() && result.ptr == last;
+    }
+
+    // bool 接受 true / false / 1 / 0
+    bool readBool(bool& value) {
+        string_view word;
+        if (!next(word)) return false;
+        if (word == "true" || word == "1") {
+            value = true;
+        } else if (word == "false" || word == "0") {
+            value = false;
+        } else {
+            return false;
+        }
+        return true;
+    }
+};
+
+// 程序 write 语句的输出：攒满缓冲区才 fwrite 一次，数值用 to_chars 格式化
+class BufferedOutput {
+private:
+    FILE* file;
+    vector<char> buffer;
+    size_t used = 0;
+
+    // 保证还有 n 字节空位
+    void reserve(size_t n) {
+        if (buffer.size() - used < n) flush();
+    }
+
+public:
+    explicit BufferedOutput(FILE* f, size_t size = 1 << 16) : file(f), buffer(size) {}
+    BufferedOutput(const BufferedOutput&) = delete;
+    BufferedOutput& operator=(const BufferedOutput&) = delete;
+
+    ~BufferedOutput() {
+        flush();
+    }
+
+    void put(char c) {
+        reserve(1);
+        buffer[used++] = c;
+    }
+
+    void writeInt(int64_t value) {
+        reserve(24);
+        used = (size_t)(to_chars(buffer.data() + used, buffer.data() + buffer.size(), value).ptr - buffer.data());
+    }
+
+    // 最短的能精确还原的十进制表示
+    void writeFloat(double value) {
+        reserve(32);
+        used = (size_t)(to_chars(buffer.data() + used, buffer.data() + buffer.size(), value).ptr - buffer.data());
+    }
+
+    void writeBool(bool value) {
+        const char* text = value ? "true" : "false";
+        size_t n = strlen(text);
+        reserve(n);
+        memcpy(buffer.data() + used, text, n);
+        used += n;
+    }
+
+    void flush() {
+        if (used == 0) return;
+        fwrite(buffer.data(), 1, used, file);
+        used = 0;
+        fflush(file);
+    }
+};
+
+#endif // BUFFERED_IO_H
@@ -0,0 +1,364 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "program.h"
+using namespace std;
+
+// 寄存器字节码的指令。每条指令最多三个操作数 a b c：
+//   运算      a = b op c（或 a = op b），a b c 都是寄存器
+//   跳转      a 是目标指令下标，条件跳转比较 b 和 c（JT / JF 只看 b）
+//   读写      a 是变量寄存器；PUTC 输出字符 a
+// 运算和比较按 int / float / bool 分成不同的指令，执行时不再判断类型。
+// 条件里的比较与跳转合成一条指令（J* 条件成立时跳转，JN* 不成立时跳转）；
+// for 循环末尾的 i++ 与回跳合成一条 INC_J* / DEC_J*（b 加减一后与 c 比较，成立时跳到 a）。
+// 这张表同时生成指令枚举、反汇编用的名字和直接线索化分派的标号表，三者顺序一致
+#define BYTECODE_OPS(X) \
+    X(HALT) X(MOV) X(JMP) X(JT) X(JF) \
+    X(ADD_I) X(SUB_I) X(MUL_I) X(DIV_I) X(ADD_F) X(SUB_F) X(MUL_F) X(DIV_F) \
+    X(EQ_I) X(NE_I) X(LT_I) X(LE_I) X(GT_I) X(GE_I) \
+    X(EQ_F) X(NE_F) X(LT_F) X(LE_F) X(GT_F) X(GE_F) X(EQ_B) X(NE_B) \
+    X(JEQ_I) X(JNE_I) X(JLT_I) X(JLE_I) X(JGT_I) X(JGE_I) \
+    X(JEQ_F) X(JNE_F) X(JLT_F) X(JLE_F) X(JGT_F) X(JGE_F) \
+    X(JNEQ_I) X(JNNE_I) X(JNLT_I) X(JNLE_I) X(JNGT_I) X(JNGE_I) \
+    X(JNEQ_F) X(JNNE_F) X(JNLT_F) X(JNLE_F) X(JNGT_F) X(JNGE_F) \
+    X(NOT) X(NEG_I) X(NEG_F) X(I2F) X(F2I) X(I2B) X(F2B) \
+    X(INC_I) X(DEC_I) X(INC_F) X(DEC_F) \
+    X(INC_JLT_I) X(INC_JLE_I) X(DEC_JGT_I) X(DEC_JGE_I) \
+    X(READ_I) X(READ_F) X(READ_B) X(WRITE_I) X(WRITE_F) X(WRITE_B) X(PUTC)
+
+enum BytecodeOp : uint8_t {
+#define BYTECODE_ENUM(name) BC_##name,
+    BYTECODE_OPS(BYTECODE_ENUM)
+#undef BYTECODE_ENUM
+    BC_COUNT
+};
+
+inline const char* bytecodeOpName(BytecodeOp op) {
+    static const char* const names[] = {
+#define BYTECODE_NAME(name) #name,
+        BYTECODE_OPS(BYTECODE_NAME)
+#undef BYTECODE_NAME
+    };
+    return op < BC_COUNT ? names[op] : "?";
+}
+
+// 指令是否跳转（目标在 a）
+inline bool bytecodeIsJump(BytecodeOp op) {
+    return op == BC_JMP || op == BC_JT || op == BC_JF || (op >= BC_JEQ_I && op <= BC_JNGE_F) ||
+           (op >= BC_INC_JLT_I && op <= BC_DEC_JGE_I);
+}
+
+struct Instr {
+    BytecodeOp op;
+    uint32_t a = 0, b = 0, c = 0;
+};
+
+// 编译结果。寄存器依次是：变量槽 [0, slotCount)，临时寄存器，常数寄存器 [constantBase, registerCount)。
+// 常数寄存器在开始执行前装入 constants，之后只读，运算可以直接引用常数而不需要装载指令
+struct Bytecode {
+    vector<Instr> code;
+    vector<Value> constants;
+    vector<string> slotNames; // 变量名（运行时错误信息用）
+    uint32_t slotCount = 0;
+    uint32_t constantBase = 0;
+    uint32_t registerCount = 0;
+};
+
+// 把 Program 编译成寄存器字节码。变量直接用自己的槽作寄存器，表达式的中间结果
+// 按栈的方式分配临时寄存器，赋值语句的结果直接写进目标变量；
+// while / for 先判断一次条件，之后条件放在循环体末尾，每轮只执行一条条件跳转
+class BytecodeCompiler {
+private:
+    // 编译期间常数寄存器的编号带这个标志，编译结束后换成真正的寄存器号
+    static constexpr uint32_t CONSTANT_FLAG = 0x80000000u;
+
+    const Program& program;
+    Bytecode& out;
+    unordered_map<uint64_t, uint32_t> constantIndex[3]; // 按类型：值的位模式 -> 常数序号
+    uint32_t tempTop;  // 下一个空闲的临时寄存器
+    uint32_t tempMax;  // 临时寄存器用到的最高位置
+
+    const ExecNode& node(uint32_t n) const {
+        return program.nodes[n];
+    }
+
+    uint32_t here() const {
+        return (uint32_t)out.code.size();
+    }
+
+    uint32_t emit(BytecodeOp op, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0) {
+        out.code.push_back({op, a, b, c});
+        return here() - 1;
+    }
+
+    // 把一组跳转指令的目标设为 target
+    void patch(const vector<uint32_t>& jumps, uint32_t target) {
+        for (uint32_t i : jumps) out.code[i].a = target;
+    }
+
+    uint32_t temp() {
+        uint32_t reg = tempTop++;
+        if (tempTop > tempMax) tempMax = tempTop;
+        return reg;
+    }
+
+    // 相同类型、相同值的常数共用一个寄存器
+    uint32_t constant(ValueType type, Value value) {
+        Value stored = type == TYPE_BOOL ? boolValue(value.b) : value;
+        uint64_t bits;
+        memcpy(&bits, &stored, sizeof(bits));
+        auto inserted = constantIndex[type].emplace(bits, (uint32_t)out.constants.size());
+        if (inserted.second) out.constants.push_back(stored);
+        return CONSTANT_FLAG | inserted.first->second;
+    }
+
+    static Value boolValue(bool b) {
+        Value v;
+        v.i = 0;
+        v.b = b;
+        return v;
+    }
+
+    // 求值表达式 n，返回结果所在的寄存器。dest 是建议的结果寄存器（赋值的目标变量），
+    // 变量和常数直接返回它们自己的寄存器，调用方按需补一条 MOV
+    uint32_t compileExpr(uint32_t n, uint32_t dest = NO_NODE) {
+        const ExecNode& x = node(n);
+        if (x.op == X_CONST) return constant(x.type, x.value);
+        if (x.op == X_LOAD) return x.a;
+
+        if (x.op >= X_ADD_I && x.op <= X_NE_B) {
+            uint32_t mark = tempTop;
+            uint32_t left = compileExpr(x.a);
+            uint32_t right = compileExpr(x.b);
+            tempTop = mark;
+            uint32_t result = dest != NO_NODE ? dest : temp();
+            emit((BytecodeOp)(BC_ADD_I + (x.op - X_ADD_I)), result, left, right);
+            return result;
+        }
+        if (x.op == X_AND || x.op == X_OR) {
+            // 短路求值编成跳转；结果先放在临时寄存器里，避免目标变量在条件中途被改写
+            uint32_t result = temp();
+            emit(BC_MOV, result, constant(TYPE_BOOL, boolValue(false)));
+            vector<uint32_t> isFalse;
+            compileBranch(n, false, isFalse);
+            emit(BC_MOV, result, constant(TYPE_BOOL, boolValue(true)));
+            patch(isFalse, here());
+            return result;
+        }
+
+        BytecodeOp op;
+        switch (x.op) {
+        case X_NOT:   op = BC_NOT; break;
+        case X_NEG_I: op = BC_NEG_I; break;
+        case X_NEG_F: op = BC_NEG_F; break;
+        case X_I2F:   op = BC_I2F; break;
+        case X_F2I:   op = BC_F2I; break;
+        case X_I2B:   op = BC_I2B; break;
+        default:      op = BC_F2B; break;
+        }
+        uint32_t mark = tempTop;
+        uint32_t operand = compileExpr(x.a);
+        tempTop = mark;
+        uint32_t result = dest != NO_NODE ? dest : temp();
+        emit(op, result, operand);
+        return result;
+    }
+
+    // 条件 n 的值等于 when 时跳转，跳转指令的下标记入 jumps 由调用方回填目标
+    void compileBranch(uint32_t n, bool when, vector<uint32_t>& jumps) {
+        const ExecNode& x = node(n);
+        switch (x.op) {
+        case X_CONST:
+            if (x.value.b == when) jumps.push_back(emit(BC_JMP));
+            return;
+        case X_NOT:
+            compileBranch(x.a, !when, jumps);
+            return;
+        case X_AND:
+        case X_OR: {
+            // a && b 为假：a 为假或 b 为假；为真：a 为真且 b 为真（a 为假时跳过 b）
+            bool shortCircuit = x.op == X_OR; // a 取这个值时整个条件就确定了
+            if (when == shortCircuit) {
+                compileBranch(x.a, when, jumps);
+                compileBranch(x.b, when, jumps);
+            } else {
+                vector<uint32_t> skip;
+                compileBranch(x.a, shortCircuit, skip);
+                compileBranch(x.b, when, jumps);
+                patch(skip, here());
+            }
+            return;
+        }
+        default:
+            break;
+        }
+
+        if (x.op >= X_EQ_I && x.op <= X_GE_F) {
+            uint32_t mark = tempTop;
+            uint32_t left = compileExpr(x.a);
+            uint32_t right = compileExpr(x.b);
+            tempTop = mark;
+            BytecodeOp base = when ? BC_JEQ_I : BC_JNEQ_I;
+            jumps.push_back(emit((BytecodeOp)(base + (x.op - X_EQ_I)), 0, left, right));
+            return;
+        }
+        uint32_t mark = tempTop;
+        uint32_t reg = compileExpr(n);
+        tempTop = mark;
+        jumps.push_back(emit(when ? BC_JT : BC_JF, 0, reg));
+    }
+
+    void compileStmt(uint32_t n) {
+        const ExecNode& x = node(n);
+        switch (x.op) {
+        case X_SEQ:
+            for (uint32_t i = 0; i < x.b; ++i) compileStmt(program.lists[x.a + i]);
+            return;
+        case X_ASSIGN: {
+            uint32_t reg = compileExpr(x.b, x.a);
+            if (reg != x.a) emit(BC_MOV, x.a, reg);
+            return;
+        }
+        case X_INC:
+            emit(x.type == TYPE_INT ? BC_INC_I : BC_INC_F, x.a);
+            return;
+        case X_DEC:
+            emit(x.type == TYPE_INT ? BC_DEC_I : BC_DEC_F, x.a);
+            return;
+        case X_IF: {
+            vector<uint32_t> toElse;
+            compileBranch(x.a, false, toElse);
+            compileStmt(x.b);
+            if (x.c == NO_NODE) {
+                patch(toElse, here());
+                return;
+            }
+            uint32_t toEnd = emit(BC_JMP);
+            patch(toElse, here());
+            compileStmt(x.c);
+            out.code[toEnd].a = here();
+            return;
+        }
+        case X_WHILE:
+            compileLoop(x.a, x.b, NO_NODE);
+            return;
+        case X_FOR:
+            if (x.a != NO_NODE) compileStmt(x.a);
+            compileLoop(x.b, x.d, x.c);
+            return;
+        case X_READ:
+            for (uint32_t i = 0; i < x.b; ++i) {
+                uint32_t slot = program.lists[x.a + i];
+                ValueType type = program.slotTypes[slot];
+                emit(type == TYPE_INT ? BC_READ_I : type == TYPE_FLOAT ? BC_READ_F : BC_READ_B, slot);
+            }
+            return;
+        case X_WRITE:
+            for (uint32_t i = 0; i < x.b; ++i) {
+                uint32_t slot = program.lists[x.a + i];
+                ValueType type = program.slotTypes[slot];
+                if (i > 0) emit(BC_PUTC, ' ');
+                emit(type == TYPE_INT ? BC_WRITE_I : type == TYPE_FLOAT ? BC_WRITE_F : BC_WRITE_B, slot);
+            }
+            emit(BC_PUTC, '\n');
+            return;
+        default:
+            return;
+        }
+    }
+
+    // 循环：入口处条件不成立时跳过整个循环，循环体末尾条件成立时跳回开头
+    // （cond 为 NO_NODE 表示永真）。条件编译了两份，换来每轮少一次无条件跳转
+    void compileLoop(uint32_t cond, uint32_t body, uint32_t update) {
+        vector<uint32_t> toEnd;
+        if (cond != NO_NODE) compileBranch(cond, false, toEnd);
+        uint32_t top = here();
+        compileStmt(body);
+        uint32_t step = here();
+        if (update != NO_NODE) compileStmt(update);
+        if (cond == NO_NODE) {
+            emit(BC_JMP, top);
+        } else {
+            uint32_t start = here();
+            vector<uint32_t> toTop;
+            compileBranch(cond, true, toTop);
+            patch(toTop, top);
+            // 只有更新部分恰好编出一条指令、条件只有一条跳转时才可能合并
+            if (update != NO_NODE && start == step + 1 && here() == start + 1) fuseLoopStep(top);
+        }
+        patch(toEnd, here());
+    }
+
+    // 末尾是 "INC_I i; JLT_I top i n" 这样的两条指令时合成一条。
+    // 循环体里有跳到回跳指令的地方时不能合并，否则跳过去会多做一次加减
+    void fuseLoopStep(uint32_t top) {
+        size_t n = out.code.size();
+        if (n < 2 || n - 2 < top) return;
+        for (size_t i = top; i < n - 1; ++i) {
+            if (bytecodeIsJump(out.code[i].op) && out.code[i].a == n - 1) return;
+        }
+        Instr& step = out.code[n - 2];
+        const Instr& jump = out.code[n - 1];
+        if (jump.b != step.a) return;
+        BytecodeOp fused;
+        if (step.op == BC_INC_I && jump.op == BC_JLT_I) {
+            fused = BC_INC_JLT_I;
+        } else if (step.op == BC_INC_I && jump.op == BC_JLE_I) {
+            fused = BC_INC_JLE_I;
+        } else if (step.op == BC_DEC_I && jump.op == BC_JGT_I) {
+            fused = BC_DEC_JGT_I;
+        } else if (step.op == BC_DEC_I && jump.op == BC_JGE_I) {
+            fused = BC_DEC_JGE_I;
+        } else {
+            return;
+        }
+        step = {fused, jump.a, step.a, jump.c};
+        out.code.pop_back();
+    }
+
+    // 常数寄存器放在临时寄存器之后，临时寄存器的个数要等编译完才知道
+    void placeConstants() {
+        out.constantBase = tempMax;
+        out.registerCount = out.constantBase + (uint32_t)out.constants.size();
+        for (Instr& instr : out.code) {
+            if (instr.b & CONSTANT_FLAG) instr.b = out.constantBase + (instr.b & ~CONSTANT_FLAG);
+            if (instr.c & CONSTANT_FLAG) instr.c = out.constantBase + (instr.c & ~CONSTANT_FLAG);
+        }
+    }
+
+public:
+    BytecodeCompiler(const Program& p, Bytecode& b) : program(p), out(b) {
+        out.slotCount = (uint32_t)program.slotTypes.size();
+        out.slotNames = program.slotNames;
+        tempTop = tempMax = out.slotCount;
+    }
+
+    void compile() {
+        compileStmt(program.root);
+        emit(BC_HALT);
+        placeConstants();
+    }
+};
+
+inline void compileBytecode(const Program& program, Bytecode& bytecode) {
+    BytecodeCompiler compiler(program, bytecode);
+    compiler.compile();
+}
+
+// 反汇编，每行一条指令（调试用）
+inline void dumpBytecode(const Bytecode& bytecode, ostream& out) {
+    out << "; " << bytecode.slotCount << " variables, " << bytecode.constantBase - bytecode.slotCount
+        << " temporaries, " << bytecode.constants.size() << " constants\n";
+    for (size_t i = 0; i < bytecode.code.size(); ++i) {
+        const Instr& instr = bytecode.code[i];
+        out << i << "\t" << bytecodeOpName(instr.op) << "\t" << instr.a << " " << instr.b << " " << instr.c << '\n';
+    }
+}
+
+#endif // BYTECODE_H
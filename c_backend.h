@@ -0,0 +1,520 @@
+#ifndef C_BACKEND_H
+#define C_BACKEND_H
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "program.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <spawn.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
+using namespace std;
+
+// 生成的 C 程序的运行时部分：缓冲的标准输入输出，以及与解释器一致的运算和错误。
+//   整数运算按 64 位补码回绕，整数除以 0、float 转 int 越界是运行时错误；
+//   read 按空白切分单词，int / float 的接受规则与 from_chars 相同，bool 接受 true / false / 1 / 0；
+//   write 的 float 输出最短的能精确还原的十进制表示，定点和科学计数法取较短者（相同时取定点），
+//   与 to_chars 一致
+static const char C_PRELUDE[] = R"C(#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* 浮点运算必须逐条舍入，编译时不要打开 -ffast-math，也不要把乘加合成 FMA（-ffp-contract=off） */
+
+#define ADD_I(a, b) ((int64_t)((uint64_t)(a) + (uint64_t)(b)))
+#define SUB_I(a, b) ((int64_t)((uint64_t)(a) - (uint64_t)(b)))
+#define MUL_I(a, b) ((int64_t)((uint64_t)(a) * (uint64_t)(b)))
+#define NEG_I(a) ((int64_t)(0 - (uint64_t)(a)))
+
+static char out_buf[1 << 16];
+static size_t out_used;
+
+static inline void out_flush(void) {
+    if (out_used == 0) return;
+    fwrite(out_buf, 1, out_used, stdout);
+    out_used = 0;
+    fflush(stdout);
+}
+
+static inline void put_text(const char* text, size_t n) {
+    if (sizeof out_buf - out_used < n) out_flush();
+    memcpy(out_buf + out_used, text, n);
+    out_used += n;
+}
+
+static inline void put_char(char c) {
+    if (out_used == sizeof out_buf) out_flush();
+    out_buf[out_used++] = c;
+}
+
+static inline void write_int(int64_t value) {
+    char text[24];
+    put_text(text, (size_t)snprintf(text, sizeof text, "%" PRId64, value));
+}
+
+static inline void write_bool(bool value) {
+    if (value) put_text("true", 4);
+    else put_text("false", 5);
+}
+
+static inline void write_float(double value) {
+    char text[32], digits[20];
+    int nd = 0, exponent, p;
+    bool negative = signbit(value) != 0;
+    const char* s;
+    if (isnan(value) || isinf(value) || value == 0) {
+        const char* word = isnan(value) ? "nan" : isinf(value) ? "inf" : "0";
+        if (negative) put_char('-');
+        put_text(word, strlen(word));
+        return;
+    }
+    /* 能还原原值的最少有效数字 */
+    for (p = 0; p < 17; ++p) {
+        snprintf(text, sizeof text, "%.*e", p, value);
+        if (strtod(text, NULL) == value) break;
+    }
+    for (s = text + negative; *s != 'e'; ++s) {
+        if (*s != '.') digits[nd++] = *s;
+    }
+    exponent = atoi(s + 1);
+
+    /* 定点表示的整数部分超出有效数字时，输出的是精确的整数值 */
+    char whole[320];
+    int expDigits = abs(exponent) >= 100 ? 3 : 2;
+    int sciLength = nd + (nd > 1) + 2 + expDigits;
+    int fixLength = exponent >= nd - 1 ? snprintf(whole, sizeof whole, "%.0f", fabs(value))
+                    : exponent >= 0 ? nd + 1 : nd + 1 - exponent;
+    if (negative) put_char('-');
+    if (fixLength <= sciLength) {
+        if (exponent >= nd - 1) {
+            put_text(whole, (size_t)fixLength);
+        } else if (exponent >= 0) {
+            put_text(digits, (size_t)exponent + 1);
+            put_char('.');
+            put_text(digits + exponent + 1, (size_t)(nd - exponent - 1));
+        } else {
+            put_text("0.", 2);
+            for (int i = -1; i > exponent; --i) put_char('0');
+            put_text(digits, (size_t)nd);
+        }
+    } else {
+        put_char(digits[0]);
+        if (nd > 1) {
+            put_char('.');
+            put_text(digits + 1, (size_t)nd - 1);
+        }
+        put_text(text, (size_t)snprintf(text, sizeof text, "e%c%0*d", exponent < 0 ? '-' : '+', expDigits, abs(exponent)));
+    }
+}
+
+static char* in_buf;
+static size_t in_size, in_begin, in_end;
+static bool in_eof;
+
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+/* 把未读部分移到缓冲区开头并接着读入，缓冲区已满时加倍（多留一个字节放单词末尾的 0） */
+static inline void in_refill(void) {
+    if (in_begin > 0) {
+        memmove(in_buf, in_buf + in_begin, in_end - in_begin);
+        in_end -= in_begin;
+        in_begin = 0;
+    }
+    if (in_end == in_size) {
+        in_size = in_size ? in_size * 2 : 1 << 16;
+        in_buf = (char*)realloc(in_buf, in_size + 1);
+        if (!in_buf) abort();
+    }
+    size_t n = fread(in_buf + in_end, 1, in_size - in_end, stdin);
+    in_end += n;
+    if (n == 0) in_eof = true;
+}
+
+/* 下一个以空白分隔的单词，以 0 结尾，下一次读取后失效；输入结束时返回 NULL */
+static inline char* next_word(void) {
+    for (;;) {
+        while (in_begin < in_end && is_space(in_buf[in_begin])) ++in_begin;
+        if (in_begin == in_end) {
+            if (in_eof) return NULL;
+            in_refill();
+            continue;
+        }
+        size_t p = in_begin;
+        while (p < in_end && !is_space(in_buf[p])) ++p;
+        if (p == in_end && !in_eof) {
+            in_refill();
+            continue;
+        }
+        char* word = in_buf + in_begin;
+        in_buf[p] = 0; /* 覆盖的是已经切分出的空白，或缓冲区末尾多留的字节 */
+        in_begin = p < in_end ? p + 1 : p;
+        return word;
+    }
+}
+
+static inline bool read_int(int64_t* value) {
+    char* word = next_word();
+    char* end;
+    if (!word || word[0] == '+') return false;
+    errno = 0;
+    long long v = strtoll(word, &end, 10);
+    if (end == word || *end != 0 || errno != 0) return false;
+    *value = (int64_t)v;
+    return true;
+}
+
+static inline bool read_float(double* value) {
+    char* word = next_word();
+    char* end;
+    if (!word || word[0] == '+' || strpbrk(word, "xX")) return false;
+    errno = 0;
+    double v = strtod(word, &end);
+    if (end == word || *end != 0) return false;
+    if (errno == ERANGE && (v == 0 || isinf(v))) return false;
+    *value = v;
+    return true;
+}
+
+static inline bool read_bool(bool* value) {
+    char* word = next_word();
+    if (!word) return false;
+    if (strcmp(word, "true") == 0 || strcmp(word, "1") == 0) {
+        *value = true;
+    } else if (strcmp(word, "false") == 0 || strcmp(word, "0") == 0) {
+        *value = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static inline void runtime_error(const char* message) {
+    out_flush();
+    fprintf(stderr, "Runtime error: %s\n", message);
+    exit(1);
+}
+
+static inline void input_error(const char* type, const char* name) {
+    out_flush();
+    fprintf(stderr, "Runtime error: Expected %s input for %s\n", type, name);
+    exit(1);
+}
+
+static inline int64_t div_i(int64_t a, int64_t b) {
+    if (b == 0) runtime_error("Division by zero");
+    if (b == -1) return NEG_I(a); /* INT64_MIN / -1 回绕 */
+    return a / b;
+}
+
+static inline int64_t f2i(double f) {
+    if (!(f >= -9223372036854775808.0 && f < 9223372036854775808.0)) runtime_error("Float value out of int range");
+    return (int64_t)f;
+}
+
+static inline double bits_f64(uint64_t bits) {
+    double f;
+    memcpy(&f, &bits, sizeof f);
+    return f;
+}
+)C";
+
+// 把 Program 翻译成独立的 C 程序。变量是 main 的局部变量 v<槽号>，便于 C 编译器放进寄存器；
+// 运算直接写成 C 表达式。C 不规定运算数的求值顺序，两边都可能出运行时错误时
+// 先把左边存进临时变量（逗号表达式），保证报出的错误与解释器相同
+class CEmitter {
+private:
+    const Program& program;
+    ostringstream body;
+    uint32_t temps[3] = {0, 0, 0}; // 各类型临时变量的个数
+
+    const ExecNode& node(uint32_t n) const {
+        return program.nodes[n];
+    }
+
+    static const char* cType(ValueType type) {
+        switch (type) {
+        case TYPE_INT:   return "int64_t";
+        case TYPE_FLOAT: return "double";
+        default:         return "bool";
+        }
+    }
+
+    static char typeLetter(ValueType type) {
+        return type == TYPE_INT ? 'i' : type == TYPE_FLOAT ? 'f' : 'b';
+    }
+
+    static string slot(uint32_t s) {
+        return "v" + to_string(s);
+    }
+
+    static string constant(ValueType type, Value value) {
+        char text[48];
+        if (type == TYPE_BOOL) return value.b ? "true" : "false";
+        if (type == TYPE_INT) {
+            if (value.i == INT64_MIN) return "INT64_MIN";
+            snprintf(text, sizeof text, "INT64_C(%" PRId64 ")", value.i);
+            return text;
+        }
+        if (!isfinite(value.f)) {
+            uint64_t bits;
+            memcpy(&bits, &value.f, sizeof bits);
+            snprintf(text, sizeof text, "bits_f64(UINT64_C(0x%016" PRIx64 "))", bits);
+            return text;
+        }
+        snprintf(text, sizeof text, signbit(value.f) ? "(%a)" : "%a", value.f); // 十六进制浮点数，精确
+        return text;
+    }
+
+    // 求值时可能出运行时错误
+    bool canFail(uint32_t n) const {
+        const ExecNode& x = node(n);
+        switch (x.op) {
+        case X_CONST:
+        case X_LOAD:
+            return false;
+        case X_DIV_I:
+        case X_F2I:
+            return true;
+        case X_NOT:
+        case X_NEG_I:
+        case X_NEG_F:
+        case X_I2F:
+        case X_I2B:
+        case X_F2B:
+            return canFail(x.a);
+        default:
+            return canFail(x.a) || canFail(x.b);
+        }
+    }
+
+    // 二元运算：format 中 %1 %2 分别是左右运算数
+    string binary(uint32_t n, const char* format) {
+        const ExecNode& x = node(n);
+        string left = expression(x.a);
+        string right = expression(x.b);
+        string prefix;
+        if (canFail(x.a) && canFail(x.b)) {
+            ValueType type = node(x.a).type;
+            string temp = string("t") + typeLetter(type) + to_string(temps[type]++);
+            prefix = "(" + temp + " = " + left + ", ";
+            left = temp;
+        }
+        string text;
+        for (const char* p = format; *p; ++p) {
+            if (p[0] == '%' && (p[1] == '1' || p[1] == '2')) {
+                text += p[1] == '1' ? left : right;
+                ++p;
+            } else {
+                text += *p;
+            }
+        }
+        return prefix.empty() ? text : prefix + text + ")";
+    }
+
+    string expression(uint32_t n) {
+        const ExecNode& x = node(n);
+        switch (x.op) {
+        case X_CONST: return constant(x.type, x.value);
+        case X_LOAD:  return slot(x.a);
+        case X_ADD_I: return binary(n, "ADD_I(%1, %2)");
+        case X_SUB_I: return binary(n, "SUB_I(%1, %2)");
+        case X_MUL_I: return binary(n, "MUL_I(%1, %2)");
+        case X_DIV_I: return binary(n, "div_i(%1, %2)");
+        case X_ADD_F: return binary(n, "(%1 + %2)");
+        case X_SUB_F: return binary(n, "(%1 - %2)");
+        case X_MUL_F: return binary(n, "(%1 * %2)");
+        case X_DIV_F: return binary(n, "(%1 / %2)");
+        case X_EQ_I:
+        case X_EQ_F:
+        case X_EQ_B:  return binary(n, "(%1 == %2)");
+        case X_NE_I:
+        case X_NE_F:
+        case X_NE_B:  return binary(n, "(%1 != %2)");
+        case X_LT_I:
+        case X_LT_F:  return binary(n, "(%1 < %2)");
+        case X_LE_I:
+        case X_LE_F:  return binary(n, "(%1 <= %2)");
+        case X_GT_I:
+        case X_GT_F:  return binary(n, "(%1 > %2)");
+        case X_GE_I:
+        case X_GE_F:  return binary(n, "(%1 >= %2)");
+        case X_AND:   return "(" + expression(x.a) + " && " + expression(x.b) + ")";
+        case X_OR:    return "(" + expression(x.a) + " || " + expression(x.b) + ")";
+        case X_NOT:   return "(!" + expression(x.a) + ")";
+        case X_NEG_I: return "NEG_I(" + expression(x.a) + ")";
+        case X_NEG_F: return "(-" + expression(x.a) + ")";
+        case X_I2F:   return "((double)" + expression(x.a) + ")";
+        case X_F2I:   return "f2i(" + expression(x.a) + ")";
+        case X_I2B:   return "(" + expression(x.a) + " != 0)";
+        case X_F2B:   return "(" + expression(x.a) + " != 0.0)";
+        default:      return "0";
+        }
+    }
+
+    // 条件去掉最外层括号，直接放进 if / while 的括号里
+    string condition(uint32_t n) {
+        string text = expression(n);
+        if (text.size() >= 2 && text.front() == '(' && text.back() == ')') {
+            int level = 0;
+            size_t i = 0;
+            for (; i < text.size(); ++i) {
+                if (text[i] == '(') ++level;
+                else if (text[i] == ')' && --level == 0) break;
+            }
+            if (i == text.size() - 1) return text.substr(1, text.size() - 2);
+        }
+        return text;
+    }
+
+    void line(int indent, const string& text) {
+        for (int i = 0; i < indent; ++i) body << "    ";
+        body << text << '\n';
+    }
+
+    // 语句块：语句序列展开，单条语句直接输出
+    void block(uint32_t n, int indent) {
+        const ExecNode& x = node(n);
+        if (x.op == X_SEQ) {
+            for (uint32_t i = 0; i < x.b; ++i) statement(program.lists[x.a + i], indent);
+        } else {
+            statement(n, indent);
+        }
+    }
+
+    void statement(uint32_t n, int indent) {
+        const ExecNode& x = node(n);
+        switch (x.op) {
+        case X_SEQ: // 变量都在 main 开头声明，嵌套的语句序列不需要自己的作用域
+            block(n, indent);
+            return;
+        case X_ASSIGN:
+            line(indent, slot(x.a) + " = " + expression(x.b) + ";");
+            return;
+        case X_INC:
+            line(indent, x.type == TYPE_INT ? slot(x.a) + " = ADD_I(" + slot(x.a) + ", 1);" : slot(x.a) + " += 1.0;");
+            return;
+        case X_DEC:
+            line(indent, x.type == TYPE_INT ? slot(x.a) + " = SUB_I(" + slot(x.a) + ", 1);" : slot(x.a) + " -= 1.0;");
+            return;
+        case X_IF:
+            line(indent, "if (" + condition(x.a) + ") {");
+            block(x.b, indent + 1);
+            if (x.c != NO_NODE) {
+                line(indent, "} else {");
+                block(x.c, indent + 1);
+            }
+            line(indent, "}");
+            return;
+        case X_WHILE:
+            line(indent, "while (" + condition(x.a) + ") {");
+            block(x.b, indent + 1);
+            line(indent, "}");
+            return;
+        case X_FOR:
+            if (x.a != NO_NODE) statement(x.a, indent);
+            line(indent, x.b == NO_NODE ? "for (;;) {" : "while (" + condition(x.b) + ") {");
+            block(x.d, indent + 1);
+            if (x.c != NO_NODE) statement(x.c, indent + 1);
+            line(indent, "}");
+            return;
+        case X_READ:
+            for (uint32_t i = 0; i < x.b; ++i) {
+                uint32_t s = program.lists[x.a + i];
+                ValueType type = program.slotTypes[s];
+                line(indent, string("if (!read_") + valueTypeToString(type) + "(&" + slot(s) + ")) input_error(\"" +
+                                 valueTypeToString(type) + "\", \"" + program.slotNames[s] + "\");");
+            }
+            return;
+        case X_WRITE:
+            for (uint32_t i = 0; i < x.b; ++i) {
+                uint32_t s = program.lists[x.a + i];
+                if (i > 0) line(indent, "put_char(' ');");
+                line(indent, string("write_") + valueTypeToString(program.slotTypes[s]) + "(" + slot(s) + ");");
+            }
+            line(indent, "put_char('\\n');");
+            return;
+        default:
+            return;
+        }
+    }
+
+public:
+    explicit CEmitter(const Program& p) : program(p) {}
+
+    void emit(ostream& out) {
+        block(program.root, 1);
+
+        out << "/* 由 parse --emit-c 生成 */\n" << C_PRELUDE << "\nint main(void) {\n";
+        for (uint32_t s = 0; s < program.slotTypes.size(); ++s) {
+            ValueType type = program.slotTypes[s];
+            out << "    " << cType(type) << ' ' << slot(s) << " = "
+                << (type == TYPE_INT ? "0" : type == TYPE_FLOAT ? "0.0" : "false") << "; /* "
+                << program.slotNames[s] << " */\n";
+        }
+        for (int type = TYPE_INT; type <= TYPE_BOOL; ++type) {
+            for (uint32_t i = 0; i < temps[type]; ++i) {
+                out << "    " << cType((ValueType)type) << " t" << typeLetter((ValueType)type) << i << ";\n";
+            }
+        }
+        out << body.str() << "    out_flush();\n    return 0;\n}\n";
+    }
+};
+
+inline void emitC(const Program& program, ostream& out) {
+    CEmitter emitter(program);
+    emitter.emit(out);
+}
+
+// 调用本机的 C 编译器（环境变量 CC，默认 cc，找不到时再试 gcc）把 source 编译成可执行文件 output
+inline bool compileC(const string& source, const string& output, string& error) {
+#if defined(__unix__) || defined(__APPLE__)
+    vector<string> compilers;
+    if (const char* cc = getenv("CC")) compilers.push_back(cc);
+    compilers.push_back("cc");
+    compilers.push_back("gcc");
+    for (const string& compiler : compilers) {
+        vector<string> args = {compiler, "-O2", "-ffp-contract=off", "-o", output, source};
+        vector<char*> argv;
+        for (string& arg : args) argv.push_back(&arg[0]);
+        argv.push_back(nullptr);
+        pid_t pid;
+        if (posix_spawnp(&pid, compiler.c_str(), nullptr, nullptr, argv.data(), environ) != 0) continue;
+        int status;
+        if (waitpid(pid, &status, 0) < 0) {
+            error = "can't wait for " + compiler;
+            return false;
+        }
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 127) continue; // 由 shell 包装的编译器不存在
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            error = compiler + " failed on " + source;
+            return false;
+        }
+        return true;
+    }
+    error = "no C compiler found (set CC)";
+    return false;
+#else
+    error = "--compile needs a POSIX system";
+    return false;
+#endif
+}
+
+#endif // C_BACKEND_H
@@ -0,0 +1,180 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include "lexer.h"
+#include "token_cursor.h"
+using namespace std;
+
+// 统计堆分配次数：替换全局 operator new
+static size_t allocationCount = 0;
+
+void* operator new(size_t size) {
+    ++allocationCount;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+// 原先语法分析器的单词符号：值是 std::string
+struct OwnedToken {
+    TokenType type;
+    string value;
+};
+
+// 原先的游标：peek/previous 按值返回，check 的参数是 const string&
+class CopyingCursor {
+private:
+    vector<OwnedToken> tokens;
+    size_t current = 0;
+
+public:
+    explicit CopyingCursor(vector<OwnedToken> t) : tokens(move(t)) {}
+
+    OwnedToken peek() const {
+        if (current < tokens.size()) return tokens[current];
+        return {TOKEN_ERROR, ""};
+    }
+
+    OwnedToken previous() const {
+        if (current > 0) return tokens[current - 1];
+        return {TOKEN_ERROR, ""};
+    }
+
+    bool isAtEnd() const {
+        return peek().type == TOKEN_ERROR && peek().value.empty();
+    }
+
+    OwnedToken advance() {
+        if (!isAtEnd()) current++;
+        return previous();
+    }
+
+    bool check(TokenType type, const string& value) const {
+        if (isAtEnd()) return false;
+        return peek().type == type && peek().value == value;
+    }
+};
+
+// 现在的游标：引用 TokenCursor 环形缓冲区中的单词符号，check 的参数是 string_view
+class ReferenceCursor {
+private:
+    TokenCursor<Lexer> tokens;
+
+public:
+    explicit ReferenceCursor(Lexer& lexer) : tokens(lexer) {}
+
+    const Token& peek() const {
+        return tokens.peek();
+    }
+
+    bool isAtEnd() const {
+        return tokens.atEnd();
+    }
+
+    const Token& advance() {
+        tokens.advance();
+        return tokens.previous();
+    }
+
+    bool check(TokenType type, string_view value) const {
+        const Token& token = peek();
+        return token.type == type && token.value == value && !isAtEnd();
+    }
+};
+
+// 没有指定输入文件时生成表达式为主的源程序（含较长的标识符，超出 std::string 的短串优化）
+string makeExpressionSource(size_t count) {
+    const char* words[] = {
+        "a", "i", "count", "total_sum", "x1", "accumulatedValue", "loop_counter_index",
+        "veryLongIdentifierName_42", "3", "42", "3.14", "+", "-", "*", "/", "(", ")", "==", "<="
+    };
+    string source;
+    unsigned seed = 12345;
+    for (size_t i = 0; i < count; ++i) {
+        seed = seed * 1103515245 + 12345;
+        source += words[(seed >> 16) % (sizeof(words) / sizeof(words[0]))];
+        source += (i % 16 == 15) ? ";\n" : " ";
+    }
+    return source;
+}
+
+// 每个单词符号上做一次 parseArithmeticExpr 循环条件的判断（六次 check），然后前进
+template <typename Cursor>
+size_t scanTokens(Cursor& cursor) {
+    size_t hits = 0, count = 0;
+    while (!cursor.isAtEnd()) {
+        if (!cursor.check(TOKEN_SEP, ";") && !cursor.check(TOKEN_SEP, ",") &&
+            !cursor.check(TOKEN_KEYWORD, "then") && !cursor.check(TOKEN_KEYWORD, "do") &&
+            !cursor.check(TOKEN_KEYWORD, "else") && !cursor.check(TOKEN_SEP, "{")) {
+            ++hits;
+        }
+        hits += cursor.advance().value.size();
+        ++count;
+    }
+    return hits + count;
+}
+
+template <typename Run>
+void runBench(const char* name, size_t tokenCount, Run run) {
+    size_t allocationsBefore = allocationCount;
+    auto begin = chrono::steady_clock::now();
+    size_t checksum = run();
+    auto end = chrono::steady_clock::now();
+    size_t allocations = allocationCount - allocationsBefore;
+    double ns = chrono::duration<double, nano>(end - begin).count() / double(tokenCount);
+    cout << name << ": " << double(allocations) / double(tokenCount) << " allocations/token, "
+         << ns << " ns/token (checksum " << checksum << ")" << endl;
+}
+
+// 语法分析器游标微基准：按值复制 std::string 的旧游标与返回引用的 TokenCursor 对比
+// 用法：cursor_bench [源程序文件]
+int main(int argc, char* argv[]) {
+    string source;
+    if (argc > 1) {
+        ifstream inFile(argv[1]);
+        if (!inFile) {
+            cerr << "can't open " << argv[1] << endl;
+            return 1;
+        }
+        source.assign(istreambuf_iterator<char>(inFile), istreambuf_iterator<char>());
+    } else {
+        source = makeExpressionSource(1000000);
+    }
+
+    // 旧游标的输入：预先复制成 vector<OwnedToken>，不计入测量
+    vector<OwnedToken> owned;
+    Lexer collect(source);
+    while (true) {
+        Token token = collect.getNextToken();
+        if (token.type == TOKEN_ERROR && token.value.empty()) break;
+        owned.push_back({token.type, string(token.value)});
+    }
+    if (owned.empty()) {
+        cerr << "no tokens in input" << endl;
+        return 1;
+    }
+    size_t tokenCount = owned.size();
+    cout << tokenCount << " tokens" << endl;
+
+    CopyingCursor copying(move(owned));
+    runBench("copying cursor  ", tokenCount, [&] { return scanTokens(copying); });
+
+    // 新游标直接从词法分析器拉取，测量包含词法分析本身
+    runBench("reference cursor", tokenCount, [&] {
+        Lexer lexer(source);
+        ReferenceCursor cursor(lexer);
+        return scanTokens(cursor);
+    });
+    return 0;
+}
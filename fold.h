@@ -0,0 +1,414 @@
+#ifndef FOLD_H
+#define FOLD_H
+
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "program.h"
+using namespace std;
+
+// 常量折叠的统计
+struct FoldStats {
+    size_t nodesBefore = 0;     // 折叠前可达的节点数
+    size_t nodesAfter = 0;      // 折叠后的节点数
+    size_t constantsFolded = 0; // 操作数都是常数、算出结果的运算
+    size_t identities = 0;      // 按代数恒等式化简的运算（x * 1、x + 0、!!b、true && x 等）
+    size_t branchesRemoved = 0; // 条件是常数、只留下一个分支的 if / while / for
+};
+
+// 依次处理节点 n 的子节点（表达式的运算数、语句的各部分、X_SEQ 的各条语句），
+// 槽号和 read / write 的变量列表不算子节点
+template <typename F>
+void forEachExecChild(const Program& program, uint32_t n, F f) {
+    const ExecNode& node = program.nodes[n];
+    switch (node.op) {
+    case X_SEQ:
+        for (uint32_t i = 0; i < node.b; ++i) f(program.lists[node.a + i]);
+        break;
+    case X_ASSIGN:
+        f(node.b);
+        break;
+    case X_INC:
+    case X_DEC:
+    case X_READ:
+    case X_WRITE:
+    case X_CONST:
+    case X_LOAD:
+        break;
+    case X_IF:
+    case X_WHILE:
+    case X_FOR:
+        for (uint32_t child : {node.a, node.b, node.c, node.d}) {
+            if (child != NO_NODE) f(child);
+        }
+        break;
+    default:
+        f(node.a);
+        if (node.b != NO_NODE) f(node.b);
+        break;
+    }
+}
+
+// 常量折叠与代数化简：重建整个 Program，操作数都是常数的运算直接算出结果，
+// 套用恒等式去掉不起作用的运算，条件为常数的 if / while / for 只保留会执行的部分。
+// 运算的结果与解释器完全一致（整数回绕、除以 -1、浮点按 double 计算），
+// 会出运行时错误的运算（除以 0、float 转 int 越界）不折叠；
+// 丢弃运算数时（x * 0、x && false）要求它不会出错，否则保留，错误照样在运行时报出
+class ConstantFolder {
+private:
+    const Program& in;
+    Program& out;
+    FoldStats& stats;
+    vector<bool> mayFail;     // out 的节点 -> 求值时可能出运行时错误
+    vector<uint32_t> pending; // 语句序列暂存栈，各层递归共用
+
+    uint32_t add(const ExecNode& node, bool fails = false) {
+        out.nodes.push_back(node);
+        mayFail.push_back(fails);
+        return (uint32_t)out.nodes.size() - 1;
+    }
+
+    const ExecNode& node(uint32_t n) const {
+        return out.nodes[n];
+    }
+
+    bool isConst(uint32_t n) const {
+        return node(n).op == X_CONST;
+    }
+
+    // n 是常数 value（按类型比较）
+    bool isConst(uint32_t n, int64_t i, double f) const {
+        if (!isConst(n)) return false;
+        const ExecNode& c = node(n);
+        if (c.type == TYPE_INT) return c.value.i == i;
+        if (c.type == TYPE_FLOAT) return c.value.f == f && !signbit(c.value.f);
+        return false;
+    }
+
+    bool isBool(uint32_t n, bool b) const {
+        return isConst(n) && node(n).value.b == b;
+    }
+
+    static Value boolValue(bool b) {
+        Value v;
+        v.i = 0;
+        v.b = b;
+        return v;
+    }
+
+    uint32_t constant(ValueType type, Value value) {
+        ExecNode c = {X_CONST, type};
+        c.value = value;
+        return add(c);
+    }
+
+    uint32_t folded(ValueType type, Value value) {
+        ++stats.constantsFolded;
+        return constant(type, value);
+    }
+
+    uint32_t simplified(uint32_t n) {
+        ++stats.identities;
+        return n;
+    }
+
+    uint32_t emptySeq() {
+        return add({X_SEQ, TYPE_INT, (uint32_t)out.lists.size(), 0});
+    }
+
+    bool isEmptySeq(uint32_t n) const {
+        return node(n).op == X_SEQ && node(n).b == 0;
+    }
+
+    // 两个运算数都是常数时算出结果，除以 0 时返回 false
+    static bool evalBinary(ExecOp op, Value x, Value y, Value& r) {
+        switch (op) {
+        case X_ADD_I: r.i = (int64_t)((uint64_t)x.i + (uint64_t)y.i); return true;
+        case X_SUB_I: r.i = (int64_t)((uint64_t)x.i - (uint64_t)y.i); return true;
+        case X_MUL_I: r.i = (int64_t)((uint64_t)x.i * (uint64_t)y.i); return true;
+        case X_DIV_I:
+            if (y.i == 0) return false;
+            r.i = y.i == -1 ? (int64_t)(0 - (uint64_t)x.i) : x.i / y.i;
+            return true;
+        case X_ADD_F: r.f = x.f + y.f; return true;
+        case X_SUB_F: r.f = x.f - y.f; return true;
+        case X_MUL_F: r.f = x.f * y.f; return true;
+        case X_DIV_F: r.f = x.f / y.f; return true;
+        case X_EQ_I:  r = boolValue(x.i == y.i); return true;
+        case X_NE_I:  r = boolValue(x.i != y.i); return true;
+        case X_LT_I:  r = boolValue(x.i < y.i); return true;
+        case X_LE_I:  r = boolValue(x.i <= y.i); return true;
+        case X_GT_I:  r = boolValue(x.i > y.i); return true;
+        case X_GE_I:  r = boolValue(x.i >= y.i); return true;
+        case X_EQ_F:  r = boolValue(x.f == y.f); return true;
+        case X_NE_F:  r = boolValue(x.f != y.f); return true;
+        case X_LT_F:  r = boolValue(x.f < y.f); return true;
+        case X_LE_F:  r = boolValue(x.f <= y.f); return true;
+        case X_GT_F:  r = boolValue(x.f > y.f); return true;
+        case X_GE_F:  r = boolValue(x.f >= y.f); return true;
+        case X_EQ_B:  r = boolValue(x.b == y.b); return true;
+        case X_NE_B:  r = boolValue(x.b != y.b); return true;
+        default:      return false;
+        }
+    }
+
+    // 运算数是常数时算出结果，float 转 int 越界时返回 false
+    static bool evalUnary(ExecOp op, Value x, Value& r) {
+        switch (op) {
+        case X_NOT:   r = boolValue(!x.b); return true;
+        case X_NEG_I: r.i = (int64_t)(0 - (uint64_t)x.i); return true;
+        case X_NEG_F: r.f = -x.f; return true;
+        case X_I2F:   r.f = (double)x.i; return true;
+        case X_F2I:
+            if (!(x.f >= -9223372036854775808.0 && x.f < 9223372036854775808.0)) return false;
+            r.i = (int64_t)x.f;
+            return true;
+        case X_I2B:   r = boolValue(x.i != 0); return true;
+        case X_F2B:   r = boolValue(x.f != 0.0); return true;
+        default:      return false;
+        }
+    }
+
+    uint32_t foldAnd(uint32_t left, uint32_t right) {
+        if (isConst(left)) return simplified(node(left).value.b ? right : left); // true && x、false && x
+        if (isBool(right, true)) return simplified(left);                        // x && true
+        if (isBool(right, false) && !mayFail[left]) return simplified(right);    // x && false
+        return add({X_AND, TYPE_BOOL, left, right}, mayFail[left] || mayFail[right]);
+    }
+
+    uint32_t foldOr(uint32_t left, uint32_t right) {
+        if (isConst(left)) return simplified(node(left).value.b ? left : right); // true || x、false || x
+        if (isBool(right, false)) return simplified(left);                       // x || false
+        if (isBool(right, true) && !mayFail[left]) return simplified(right);     // x || true
+        return add({X_OR, TYPE_BOOL, left, right}, mayFail[left] || mayFail[right]);
+    }
+
+    uint32_t foldBinary(ExecOp op, ValueType type, uint32_t left, uint32_t right) {
+        if (op == X_AND) return foldAnd(left, right);
+        if (op == X_OR) return foldOr(left, right);
+        Value r;
+        if (isConst(left) && isConst(right) && evalBinary(op, node(left).value, node(right).value, r)) {
+            return folded(type, r);
+        }
+        switch (op) {
+        case X_ADD_I:
+            if (isConst(left, 0, 0)) return simplified(right); // 0 + x
+            if (isConst(right, 0, 0)) return simplified(left); // x + 0
+            break;
+        case X_SUB_I:
+        case X_SUB_F:
+            if (isConst(right, 0, 0)) return simplified(left); // x - 0（-0.0 - 0.0 仍是 -0.0）
+            break;
+        case X_MUL_I:
+            if (isConst(left, 1, 1)) return simplified(right); // 1 * x
+            if (isConst(right, 1, 1)) return simplified(left); // x * 1
+            if (isConst(right, 0, 0) && !mayFail[left]) return simplified(right); // x * 0（浮点不适用：NaN、-0.0）
+            if (isConst(left, 0, 0) && !mayFail[right]) return simplified(left);
+            break;
+        case X_MUL_F:
+            if (isConst(left, 1, 1)) return simplified(right);
+            if (isConst(right, 1, 1)) return simplified(left);
+            break;
+        case X_DIV_I:
+        case X_DIV_F:
+            if (isConst(right, 1, 1)) return simplified(left); // x / 1
+            break;
+        case X_EQ_B:
+        case X_NE_B: {
+            // b == true、b != false 就是 b；b == false、b != true 是 !b
+            if (!isConst(left) && !isConst(right)) break;
+            uint32_t other = isConst(right) ? left : right;
+            bool c = node(isConst(right) ? right : left).value.b;
+            if (c == (op == X_EQ_B)) return simplified(other);
+            return simplified(foldUnary(X_NOT, TYPE_BOOL, other));
+        }
+        default:
+            break;
+        }
+        // 整数除数是非 0 常数时不会出错
+        bool fails = mayFail[left] || mayFail[right] ||
+                     (op == X_DIV_I && !(isConst(right) && node(right).value.i != 0));
+        return add({op, type, left, right}, fails);
+    }
+
+    uint32_t foldUnary(ExecOp op, ValueType type, uint32_t operand) {
+        Value r;
+        if (isConst(operand) && evalUnary(op, node(operand).value, r)) {
+            return folded(type, r);
+        }
+        ExecNode inner = node(operand);
+        if ((op == X_NOT && inner.op == X_NOT) || (op == X_NEG_I && inner.op == X_NEG_I) ||
+            (op == X_NEG_F && inner.op == X_NEG_F)) {
+            return simplified(inner.a); // !!b、-(-x)
+        }
+        // !(a < b) 换成 a >= b；只对整数比较，浮点比较遇到 NaN 时两者不同
+        if (op == X_NOT && inner.op >= X_EQ_I && inner.op <= X_GE_I) {
+            static const ExecOp inverse[] = {X_NE_I, X_EQ_I, X_GE_I, X_GT_I, X_LE_I, X_LT_I};
+            ++stats.identities;
+            return add({inverse[inner.op - X_EQ_I], TYPE_BOOL, inner.a, inner.b}, mayFail[operand]);
+        }
+        return add({op, type, operand}, mayFail[operand] || op == X_F2I);
+    }
+
+    uint32_t expr(uint32_t n) {
+        const ExecNode& e = in.nodes[n];
+        switch (e.op) {
+        case X_CONST:
+            return constant(e.type, e.value);
+        case X_LOAD:
+            return add(e);
+        case X_NOT:
+        case X_NEG_I:
+        case X_NEG_F:
+        case X_I2F:
+        case X_F2I:
+        case X_I2B:
+        case X_F2B:
+            return foldUnary(e.op, e.type, expr(e.a));
+        default: {
+            uint32_t left = expr(e.a);
+            return foldBinary(e.op, e.type, left, expr(e.b));
+        }
+        }
+    }
+
+    // 复制 read / write 的变量列表
+    uint32_t copyList(uint32_t start, uint32_t count) {
+        uint32_t first = (uint32_t)out.lists.size();
+        out.lists.insert(out.lists.end(), in.lists.begin() + start, in.lists.begin() + start + count);
+        return first;
+    }
+
+    uint32_t stmt(uint32_t n) {
+        const ExecNode& s = in.nodes[n];
+        switch (s.op) {
+        case X_SEQ: {
+            size_t first = pending.size();
+            for (uint32_t i = 0; i < s.b; ++i) {
+                uint32_t child = stmt(in.lists[s.a + i]);
+                if (!isEmptySeq(child)) pending.push_back(child);
+            }
+            uint32_t listStart = (uint32_t)out.lists.size();
+            out.lists.insert(out.lists.end(), pending.begin() + first, pending.end());
+            pending.resize(first);
+            return add({X_SEQ, TYPE_INT, listStart, (uint32_t)(out.lists.size() - listStart)});
+        }
+        case X_ASSIGN:
+            return add({X_ASSIGN, s.type, s.a, expr(s.b)});
+        case X_INC:
+        case X_DEC:
+            return add(s);
+        case X_READ:
+        case X_WRITE:
+            return add({s.op, s.type, copyList(s.a, s.b), s.b});
+        case X_IF: {
+            uint32_t cond = expr(s.a);
+            if (isConst(cond)) {
+                ++stats.branchesRemoved;
+                if (node(cond).value.b) return stmt(s.b);
+                return s.c == NO_NODE ? emptySeq() : stmt(s.c);
+            }
+            uint32_t thenBranch = stmt(s.b);
+            uint32_t elseBranch = s.c == NO_NODE ? NO_NODE : stmt(s.c);
+            if (elseBranch != NO_NODE && isEmptySeq(elseBranch)) elseBranch = NO_NODE;
+            return add({X_IF, TYPE_INT, cond, thenBranch, elseBranch});
+        }
+        case X_WHILE: {
+            uint32_t cond = expr(s.a);
+            if (isBool(cond, false)) {
+                ++stats.branchesRemoved;
+                return emptySeq();
+            }
+            return add({X_WHILE, TYPE_INT, cond, stmt(s.b)});
+        }
+        case X_FOR: {
+            uint32_t init = s.a == NO_NODE ? NO_NODE : stmt(s.a);
+            uint32_t cond = s.b == NO_NODE ? NO_NODE : expr(s.b);
+            if (cond != NO_NODE && isBool(cond, false)) { // 循环体一次也不执行，只剩初始化部分
+                ++stats.branchesRemoved;
+                return init == NO_NODE ? emptySeq() : init;
+            }
+            if (cond != NO_NODE && isConst(cond)) { // for (; true;) 同 for (;;)
+                ++stats.identities;
+                cond = NO_NODE;
+            }
+            uint32_t update = s.c == NO_NODE ? NO_NODE : stmt(s.c);
+            return add({X_FOR, TYPE_INT, init, cond, update, stmt(s.d)});
+        }
+        default:
+            return expr(n);
+        }
+    }
+
+    // 按后序把 from 中从 n 可达的节点复制到 out，子节点仍在父节点之前；返回新的下标
+    uint32_t copyReachable(const Program& from, uint32_t n) {
+        ExecNode e = from.nodes[n];
+        if (e.op == X_SEQ) {
+            size_t first = pending.size();
+            for (uint32_t i = 0; i < e.b; ++i) pending.push_back(from.lists[e.a + i]);
+            for (size_t i = first; i < pending.size(); ++i) {
+                uint32_t child = copyReachable(from, pending[i]);
+                pending[i] = child;
+            }
+            e.a = (uint32_t)out.lists.size();
+            out.lists.insert(out.lists.end(), pending.begin() + first, pending.end());
+            pending.resize(first);
+        } else if (e.op == X_READ || e.op == X_WRITE) {
+            uint32_t start = e.a;
+            e.a = (uint32_t)out.lists.size();
+            out.lists.insert(out.lists.end(), from.lists.begin() + start, from.lists.begin() + start + e.b);
+        } else if (e.op == X_ASSIGN) {
+            e.b = copyReachable(from, e.b);
+        } else if (e.op != X_INC && e.op != X_DEC && e.op != X_CONST && e.op != X_LOAD) {
+            for (uint32_t* child : {&e.a, &e.b, &e.c, &e.d}) {
+                if (*child != NO_NODE) *child = copyReachable(from, *child);
+            }
+        }
+        out.nodes.push_back(e);
+        return (uint32_t)out.nodes.size() - 1;
+    }
+
+    static size_t countReachable(const Program& program, uint32_t n) {
+        size_t count = 1;
+        forEachExecChild(program, n, [&](uint32_t child) { count += countReachable(program, child); });
+        return count;
+    }
+
+public:
+    ConstantFolder(const Program& source, Program& result, FoldStats& s) : in(source), out(result), stats(s) {}
+
+    void fold() {
+        stats = FoldStats{};
+        stats.nodesBefore = countReachable(in, in.root);
+        Program folded;
+        folded.slotTypes = in.slotTypes;
+        folded.slotNames = in.slotNames;
+        {
+            // 折叠时被替换掉的节点仍留在 folded 中，最后只把可达的部分复制到结果里
+            ConstantFolder builder(in, folded, stats);
+            folded.root = builder.stmt(in.root);
+        }
+        out = Program{};
+        out.slotTypes = in.slotTypes;
+        out.slotNames = in.slotNames;
+        out.root = copyReachable(folded, folded.root);
+        stats.nodesAfter = out.nodes.size();
+    }
+};
+
+// 对 program 做常量折叠和代数化简，结果放回 program
+inline void foldProgram(Program& program, FoldStats& stats) {
+    Program source = move(program);
+    ConstantFolder folder(source, program, stats);
+    folder.fold();
+}
+
+inline void printFoldStats(const FoldStats& stats, ostream& out) {
+    out << "Constant folding: " << stats.nodesBefore << " -> " << stats.nodesAfter << " nodes ("
+        << stats.nodesBefore - stats.nodesAfter << " eliminated)" << endl;
+    out << "  constants folded: " << stats.constantsFolded << ", identities applied: " << stats.identities
+        << ", dead branches removed: " << stats.branchesRemoved << endl;
+}
+
+#endif // FOLD_H
@@ -0,0 +1,78 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "arena.h"
+using namespace std;
+
+// 字符串驻留表：相同拼写只保存一份，用 32 位编号代替字符串。
+// 开放定址哈希表（线性探测）存编号，字符串本身复制进 Arena；编号 0 固定是空串
+class StringInterner {
+private:
+    Arena arena;
+    vector<string_view> strings; // 编号 -> 字符串
+
+    // 哈希槽：编号 + 1（0 表示空槽）和哈希值的低 32 位，探测时先比哈希值，少读字符串
+    struct Slot {
+        uint32_t id;
+        uint32_t hash;
+    };
+    vector<Slot> slots;
+
+    static uint64_t hash(string_view text) {
+        uint64_t h = 14695981039346656037ull; // FNV-1a
+        for (unsigned char c : text) {
+            h = (h ^ c) * 1099511628211ull;
+        }
+        return h;
+    }
+
+    // 负载超过一半时把槽数翻倍，按槽里保存的哈希值重新插入，不再读字符串
+    void rehash() {
+        vector<Slot> old(slots.size() * 2, Slot{0, 0});
+        old.swap(slots);
+        size_t mask = slots.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.id == 0) continue;
+            size_t i = slot.hash & mask;
+            while (slots[i].id != 0) i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+    }
+
+public:
+    StringInterner() : arena(16 << 10), strings(1), slots(64, Slot{0, 0}) {}
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    // 返回 text 的编号，第一次出现时登记
+    uint32_t intern(string_view text) {
+        if (text.empty()) return 0;
+        uint32_t h = (uint32_t)hash(text);
+        size_t mask = slots.size() - 1;
+        size_t i = h & mask;
+        while (slots[i].id != 0) {
+            uint32_t id = slots[i].id - 1;
+            if (slots[i].hash == h && strings[id] == text) return id;
+            i = (i + 1) & mask;
+        }
+        uint32_t id = (uint32_t)strings.size();
+        strings.push_back(arena.copy(text));
+        slots[i] = {id + 1, h};
+        if (strings.size() * 2 > slots.size()) rehash();
+        return id;
+    }
+
+    string_view operator[](uint32_t id) const {
+        return strings[id];
+    }
+
+    // 已登记的字符串个数（含空串）
+    size_t size() const {
+        return strings.size();
+    }
+};
+
+#endif // INTERNER_H
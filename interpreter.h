@@ -0,0 +1,205 @@
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "buffered_io.h"
+#include "program.h"
+using namespace std;
+
+// 树遍历解释器：直接在 Program 的节点上递归求值。变量是槽数组中的下标，
+// 运算在解析时已按类型选定，求值时只按 op 分派一次，不查名字也不判断类型。
+// 整数运算按 64 位补码回绕，除以 0 是运行时错误
+class Interpreter {
+private:
+    struct Error {
+        string message;
+    };
+
+    const ExecNode* nodes;
+    const uint32_t* lists;
+    const Program& program;
+    vector<Value> slots;
+    BufferedInput& input;
+    BufferedOutput& output;
+
+    static int64_t wrap(uint64_t value) {
+        return (int64_t)value;
+    }
+
+    static Value ofInt(int64_t i) {
+        Value v;
+        v.i = i;
+        return v;
+    }
+
+    static Value ofFloat(double f) {
+        Value v;
+        v.f = f;
+        return v;
+    }
+
+    static Value ofBool(bool b) {
+        Value v;
+        v.i = 0;
+        v.b = b;
+        return v;
+    }
+
+    int64_t divide(int64_t a, int64_t b) {
+        if (b == 0) throw Error{"Division by zero"};
+        if (b == -1) return wrap(0 - (uint64_t)a); // INT64_MIN / -1 回绕
+        return a / b;
+    }
+
+    bool test(uint32_t n) {
+        return eval(n).b;
+    }
+
+    Value eval(uint32_t n) {
+        const ExecNode& x = nodes[n];
+        switch (x.op) {
+        case X_CONST: return x.value;
+        case X_LOAD:  return slots[x.a];
+        case X_ADD_I: return ofInt(wrap((uint64_t)eval(x.a).i + (uint64_t)eval(x.b).i));
+        case X_SUB_I: return ofInt(wrap((uint64_t)eval(x.a).i - (uint64_t)eval(x.b).i));
+        case X_MUL_I: return ofInt(wrap((uint64_t)eval(x.a).i * (uint64_t)eval(x.b).i));
+        case X_DIV_I: {
+            int64_t a = eval(x.a).i;
+            return ofInt(divide(a, eval(x.b).i));
+        }
+        case X_ADD_F: return ofFloat(eval(x.a).f + eval(x.b).f);
+        case X_SUB_F: return ofFloat(eval(x.a).f - eval(x.b).f);
+        case X_MUL_F: return ofFloat(eval(x.a).f * eval(x.b).f);
+        case X_DIV_F: return ofFloat(eval(x.a).f / eval(x.b).f);
+        case X_EQ_I:  return ofBool(eval(x.a).i == eval(x.b).i);
+        case X_NE_I:  return ofBool(eval(x.a).i != eval(x.b).i);
+        case X_LT_I:  return ofBool(eval(x.a).i < eval(x.b).i);
+        case X_LE_I:  return ofBool(eval(x.a).i <= eval(x.b).i);
+        case X_GT_I:  return ofBool(eval(x.a).i > eval(x.b).i);
+        case X_GE_I:  return ofBool(eval(x.a).i >= eval(x.b).i);
+        case X_EQ_F:  return ofBool(eval(x.a).f == eval(x.b).f);
+        case X_NE_F:  return ofBool(eval(x.a).f != eval(x.b).f);
+        case X_LT_F:  return ofBool(eval(x.a).f < eval(x.b).f);
+        case X_LE_F:  return ofBool(eval(x.a).f <= eval(x.b).f);
+        case X_GT_F:  return ofBool(eval(x.a).f > eval(x.b).f);
+        case X_GE_F:  return ofBool(eval(x.a).f >= eval(x.b).f);
+        case X_EQ_B:  return ofBool(test(x.a) == test(x.b));
+        case X_NE_B:  return ofBool(test(x.a) != test(x.b));
+        case X_AND:   return ofBool(test(x.a) && test(x.b));
+        case X_OR:    return ofBool(test(x.a) || test(x.b));
+        case X_NOT:   return ofBool(!test(x.a));
+        case X_NEG_I: return ofInt(wrap(0 - (uint64_t)eval(x.a).i));
+        case X_NEG_F: return ofFloat(-eval(x.a).f);
+        case X_I2F:   return ofFloat((double)eval(x.a).i);
+        case X_F2I:   return ofInt(floatToInt(eval(x.a).f));
+        case X_I2B:   return ofBool(eval(x.a).i != 0);
+        case X_F2B:   return ofBool(eval(x.a).f != 0.0);
+        default:      throw Error{"Bad expression node"};
+        }
+    }
+
+    // float -> int 向零截断，超出 int64 范围或 NaN 是运行时错误
+    int64_t floatToInt(double f) {
+        if (!(f >= -9223372036854775808.0 && f < 9223372036854775808.0)) {
+            throw Error{"Float value out of int range"};
+        }
+        return (int64_t)f;
+    }
+
+    void read(uint32_t slot) {
+        Value& v = slots[slot];
+        bool ok;
+        switch (program.slotTypes[slot]) {
+        case TYPE_INT:   ok = input.readInt(v.i); break;
+        case TYPE_FLOAT: ok = input.readFloat(v.f); break;
+        default:         v.i = 0; ok = input.readBool(v.b); break;
+        }
+        if (!ok) {
+            throw Error{string("Expected ") + valueTypeToString(program.slotTypes[slot]) +
+                        " input for " + program.slotNames[slot]};
+        }
+    }
+
+    void write(uint32_t slot) {
+        const Value& v = slots[slot];
+        switch (program.slotTypes[slot]) {
+        case TYPE_INT:   output.writeInt(v.i); break;
+        case TYPE_FLOAT: output.writeFloat(v.f); break;
+        default:         output.writeBool(v.b); break;
+        }
+    }
+
+    void exec(uint32_t n) {
+        const ExecNode& x = nodes[n];
+        switch (x.op) {
+        case X_SEQ:
+            for (uint32_t i = 0; i < x.b; ++i) exec(lists[x.a + i]);
+            return;
+        case X_ASSIGN:
+            slots[x.a] = eval(x.b);
+            return;
+        case X_INC:
+            if (x.type == TYPE_INT) slots[x.a].i = wrap((uint64_t)slots[x.a].i + 1);
+            else slots[x.a].f += 1.0;
+            return;
+        case X_DEC:
+            if (x.type == TYPE_INT) slots[x.a].i = wrap((uint64_t)slots[x.a].i - 1);
+            else slots[x.a].f -= 1.0;
+            return;
+        case X_IF:
+            if (test(x.a)) exec(x.b);
+            else if (x.c != NO_NODE) exec(x.c);
+            return;
+        case X_WHILE:
+            while (test(x.a)) exec(x.b);
+            return;
+        case X_FOR:
+            if (x.a != NO_NODE) exec(x.a);
+            while (x.b == NO_NODE || test(x.b)) {
+                exec(x.d);
+                if (x.c != NO_NODE) exec(x.c);
+            }
+            return;
+        case X_READ:
+            for (uint32_t i = 0; i < x.b; ++i) read(lists[x.a + i]);
+            return;
+        case X_WRITE:
+            for (uint32_t i = 0; i < x.b; ++i) {
+                if (i > 0) output.put(' ');
+                write(lists[x.a + i]);
+            }
+            output.put('\n');
+            return;
+        default:
+            throw Error{"Bad statement node"};
+        }
+    }
+
+public:
+    Interpreter(const Program& p, BufferedInput& in, BufferedOutput& out)
+        : nodes(p.nodes.data()), lists(p.lists.data()), program(p), slots(p.slotTypes.size(), Value{}),
+          input(in), output(out) {}
+
+    // 执行整个程序，运行时错误时返回 false，error 给出原因（之前的输出已写出）
+    bool run(string& error) {
+        try {
+            exec(program.root);
+            output.flush();
+            return true;
+        } catch (const Error& e) {
+            output.flush();
+            error = e.message;
+            return false;
+        }
+    }
+
+    // 变量的当前值（调试和对照用）
+    Value slot(uint32_t index) const {
+        return slots[index];
+    }
+};
+
+#endif // INTERPRETER_H
@@ -0,0 +1,982 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "buffered_io.h"
+#include "bytecode.h"
+
+// 只在 x86-64 Linux 上生成机器码（也可以用 -DJIT_AVAILABLE=0 关闭，--jit 退回虚拟机）
+#ifndef JIT_AVAILABLE
+#if defined(__x86_64__) && defined(__linux__)
+#define JIT_AVAILABLE 1
+#else
+#define JIT_AVAILABLE 0
+#endif
+#endif
+#if JIT_AVAILABLE
+#include <sys/mman.h>
+#endif
+using namespace std;
+
+// 生成的机器码通过这些函数回到运行时做输入输出。
+// 读入失败时把原因写进 error 并返回 0，机器码随即带着 JIT_EXIT_ERROR 退出
+struct JitRuntime {
+    BufferedInput* input;
+    BufferedOutput* output;
+    const Bytecode* bytecode;
+    string error;
+};
+
+enum JitExit {
+    JIT_EXIT_OK,
+    JIT_EXIT_ERROR,       // 原因在 JitRuntime::error 中
+    JIT_EXIT_DIV_ZERO,    // 整数除以 0
+    JIT_EXIT_FLOAT_RANGE  // float 转 int 越界
+};
+
+inline int jitReadInt(JitRuntime* rt, Value* slot, uint32_t index) {
+    if (rt->input->readInt(slot->i)) return 1;
+    rt->error = "Expected int input for " + rt->bytecode->slotNames[index];
+    return 0;
+}
+
+inline int jitReadFloat(JitRuntime* rt, Value* slot, uint32_t index) {
+    if (rt->input->readFloat(slot->f)) return 1;
+    rt->error = "Expected float input for " + rt->bytecode->slotNames[index];
+    return 0;
+}
+
+inline int jitReadBool(JitRuntime* rt, Value* slot, uint32_t index) {
+    slot->i = 0;
+    if (rt->input->readBool(slot->b)) return 1;
+    rt->error = "Expected bool input for " + rt->bytecode->slotNames[index];
+    return 0;
+}
+
+inline void jitWriteInt(JitRuntime* rt, int64_t value) {
+    rt->output->writeInt(value);
+}
+
+inline void jitWriteFloat(JitRuntime* rt, double value) {
+    rt->output->writeFloat(value);
+}
+
+inline void jitWriteBool(JitRuntime* rt, int64_t value) {
+    rt->output->writeBool(value != 0);
+}
+
+inline void jitPutChar(JitRuntime* rt, int64_t c) {
+    rt->output->put((char)c);
+}
+
+#if JIT_AVAILABLE
+
+// 可执行内存：先以可写方式映射并复制机器码，再改成只读可执行（不同时可写可执行）
+class NativeCode {
+private:
+    void* memory = nullptr;
+    size_t length = 0;
+
+public:
+    using Entry = int (*)(Value* registers, JitRuntime* runtime);
+
+    NativeCode() = default;
+    NativeCode(const NativeCode&) = delete;
+    NativeCode& operator=(const NativeCode&) = delete;
+
+    ~NativeCode() {
+        if (memory) munmap(memory, length);
+    }
+
+    bool load(const vector<uint8_t>& code, string& error) {
+        length = code.size();
+        memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            memory = nullptr;
+            error = "can't map memory for native code";
+            return false;
+        }
+        memcpy(memory, code.data(), length);
+        if (mprotect(memory, length, PROT_READ | PROT_EXEC) != 0) {
+            error = "can't make native code executable";
+            return false;
+        }
+        return true;
+    }
+
+    Entry entry() const {
+        return (Entry)memory;
+    }
+};
+
+// 把寄存器字节码逐条翻译成 x86-64 机器码（System V 调用约定）。
+//   rbx 指向寄存器数组，rbp 指向 JitRuntime，rax rcx rdx xmm0 xmm1 作临时寄存器；
+//   只按整数方式访问、在循环里用得最多的字节码寄存器（多是 int 变量和循环计数器）
+//   常驻 r12-r15 r8-r11 rsi rdi，其余留在内存里按 [rbx + 8 * 下标] 访问；
+//   能放进 32 位的整数常数直接编成立即数。
+// 输入输出调用运行时函数，调用前后保存、恢复调用者保存的寄存器
+class JitCompiler {
+private:
+    enum Reg { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+    enum Cond { CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_BE = 0x6, CC_A = 0x7,
+                CC_P = 0xA, CC_NP = 0xB, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF };
+
+    // 指令的操作数：寄存器，或 [rbx + disp]
+    struct Operand {
+        bool direct;
+        int reg;
+        int32_t disp;
+    };
+
+    // 跳转的 rel32 位置和目标（字节码下标，或者错误出口）
+    struct Fixup {
+        size_t at;
+        uint32_t target;
+    };
+
+    // 常驻寄存器的编号：0-15 是通用寄存器，XMM + n 是 xmmn
+    static constexpr int XMM = 16;
+    static constexpr int GPR_ALLOCATABLE[] = {R12, R13, R14, R15, R8, R9, R10, R11, RSI, RDI};
+    static constexpr int XMM_ALLOCATABLE = 14; // xmm2-xmm15，xmm0 xmm1 作临时寄存器
+
+    // 字节码寄存器被访问的方式：用通用寄存器指令，还是用 SSE 指令
+    enum Access : uint8_t { ACCESS_GPR = 1, ACCESS_SSE = 2 };
+    static constexpr uint32_t EXIT_TARGET = 0x80000000u; // 目标为错误出口时带这个标志
+
+    const Bytecode& bytecode;
+    vector<uint8_t> code;
+    vector<int> allocated;       // 字节码寄存器 -> 常驻的机器寄存器（见 XMM），-1 表示在内存中
+    vector<uint32_t> residents;  // 常驻寄存器的字节码寄存器
+    vector<size_t> offsets;      // 字节码下标 -> 机器码偏移
+    vector<Fixup> fixups;
+
+    // 上一条指令结束时 rax / xmm0 里恰好是哪个字节码寄存器的值（NOTHING 表示不确定）。
+    // 紧接着的指令（不是跳转目标时）读这个寄存器可以省掉一次装入，
+    // 避免循环里的临时值每次都经内存转发
+    static constexpr uint32_t NOTHING = UINT32_MAX;
+    uint32_t raxHolds = NOTHING, xmm0Holds = NOTHING; // 本条指令开始时
+    uint32_t raxLeft = NOTHING, xmm0Left = NOTHING;   // 本条指令结束时
+
+    void byte(uint8_t b) {
+        code.push_back(b);
+    }
+
+    void imm32(int32_t v) {
+        for (int i = 0; i < 4; ++i) byte((uint8_t)((uint32_t)v >> (8 * i)));
+    }
+
+    void imm64(uint64_t v) {
+        for (int i = 0; i < 8; ++i) byte((uint8_t)(v >> (8 * i)));
+    }
+
+    static Operand reg(int r) {
+        return {true, r, 0};
+    }
+
+    Operand operand(uint32_t r) const {
+        if (allocated[r] >= 0) return reg(allocated[r] & 15);
+        return {false, RBX, (int32_t)(r * 8)};
+    }
+
+    // [prefix] [REX] opcode ModRM [disp]，reg 是 ModRM 的 reg 字段（寄存器号或扩展操作码）
+    void emitRm(uint8_t prefix, bool wide, initializer_list<uint8_t> opcode, int regField, Operand rm) {
+        if (prefix) byte(prefix);
+        uint8_t rex = 0x40 | (wide ? 8 : 0) | ((regField & 8) ? 4 : 0) | ((rm.reg & 8) ? 1 : 0);
+        if (rex != 0x40) byte(rex);
+        for (uint8_t b : opcode) byte(b);
+        if (rm.direct) {
+            byte((uint8_t)(0xC0 | ((regField & 7) << 3) | (rm.reg & 7)));
+        } else if (rm.disp >= -128 && rm.disp <= 127) {
+            byte((uint8_t)(0x40 | ((regField & 7) << 3) | (rm.reg & 7)));
+            byte((uint8_t)rm.disp);
+        } else {
+            byte((uint8_t)(0x80 | ((regField & 7) << 3) | (rm.reg & 7)));
+            imm32(rm.disp);
+        }
+    }
+
+    // 整数常数寄存器的值能放进 32 位立即数时返回 true
+    bool immediate(uint32_t r, int32_t& value) const {
+        if (r < bytecode.constantBase) return false;
+        int64_t v = bytecode.constants[r - bytecode.constantBase].i;
+        if (v < INT32_MIN || v > INT32_MAX) return false;
+        value = (int32_t)v;
+        return true;
+    }
+
+    void movRegImm64(int r, uint64_t value) {
+        if (r == RAX) raxHolds = NOTHING;
+        byte((uint8_t)(0x48 | ((r & 8) ? 1 : 0)));
+        byte((uint8_t)(0xB8 | (r & 7)));
+        imm64(value);
+    }
+
+    // 字节码寄存器 r 在内存或常驻寄存器里被原地修改，rax / xmm0 中的副本不再有效
+    void updatedInPlace(uint32_t r) {
+        if (raxHolds == r) raxHolds = NOTHING;
+        if (xmm0Holds == r) xmm0Holds = NOTHING;
+    }
+
+    // r = 字节码寄存器 src 的 64 位值
+    void load(int r, uint32_t src) {
+        int32_t value;
+        if (r == RAX) {
+            bool held = raxHolds == src;
+            raxHolds = NOTHING;
+            if (held) return;
+        }
+        if (immediate(src, value)) {
+            emitRm(0, true, {0xC7}, 0, reg(r)); // mov r/m64, imm32
+            imm32(value);
+        } else {
+            Operand o = operand(src);
+            if (o.direct && o.reg == r) return;
+            emitRm(0, true, {0x8B}, r, o);
+        }
+    }
+
+    // 字节码寄存器 dst = r
+    void store(uint32_t dst, int r) {
+        Operand o = operand(dst);
+        if (o.direct && o.reg == r) return;
+        emitRm(0, true, {0x89}, r, o);
+    }
+
+    // r op= 字节码寄存器 src；opcode 是 "op r64, r/m64"，ext 是 "op r/m64, imm32" 的扩展操作码
+    void alu(uint8_t opcode, int ext, int r, uint32_t src) {
+        int32_t value;
+        if (immediate(src, value)) {
+            emitRm(0, true, {0x81}, ext, reg(r));
+            imm32(value);
+        } else {
+            emitRm(0, true, {opcode}, r, operand(src));
+        }
+    }
+
+    // 比较两个整数字节码寄存器，第一个已常驻机器寄存器时不必先装入 rax
+    void compareInt(uint32_t left, uint32_t right) {
+        Operand l = operand(left);
+        int r = RAX;
+        if (l.direct) {
+            r = l.reg;
+        } else {
+            load(RAX, left);
+        }
+        alu(0x3B, 7, r, right);
+    }
+
+    void movsdLoad(int xmm, uint32_t src) {
+        if (xmm == 0) {
+            bool held = xmm0Holds == src;
+            xmm0Holds = NOTHING;
+            if (held) return;
+        }
+        emitRm(0xF2, false, {0x0F, 0x10}, xmm, operand(src));
+    }
+
+    void movsdStore(uint32_t dst, int xmm) {
+        emitRm(0xF2, false, {0x0F, 0x11}, xmm, operand(dst));
+    }
+
+    // 比较两个 float；left > right 在 CC_A 下成立，交换操作数后 CC_A 表示 left < right
+    void compareFloat(uint32_t left, uint32_t right) {
+        movsdLoad(0, left);
+        emitRm(0x66, false, {0x0F, 0x2E}, 0, operand(right)); // ucomisd xmm0, m64
+    }
+
+    // al = 条件码，再零扩展到 rax
+    void setcc(Cond cc, int r8 = RAX) {
+        emitRm(0, false, {0x0F, (uint8_t)(0x90 | cc)}, 0, reg(r8));
+    }
+
+    void boolResult(uint32_t dst) {
+        emitRm(0, false, {0x0F, 0xB6}, RAX, reg(RAX)); // movzx eax, al
+        store(dst, RAX);
+        raxLeft = dst;
+    }
+
+    void jcc(Cond cc, uint32_t target) {
+        byte(0x0F);
+        byte((uint8_t)(0x80 | cc));
+        fixups.push_back({code.size(), target});
+        imm32(0);
+    }
+
+    void jmp(uint32_t target) {
+        byte(0xE9);
+        fixups.push_back({code.size(), target});
+        imm32(0);
+    }
+
+    // 机器码内部的短跳转：先占位，跳转目标确定后回填
+    size_t jcc8(Cond cc) {
+        byte((uint8_t)(0x70 | cc));
+        byte(0);
+        return code.size();
+    }
+
+    size_t jmp8() {
+        byte(0xEB);
+        byte(0);
+        return code.size();
+    }
+
+    void bind8(size_t after) {
+        code[after - 1] = (uint8_t)(code.size() - after);
+    }
+
+    static bool isXmm(int m) {
+        return m >= XMM;
+    }
+
+    // xmm 寄存器都是调用者保存的
+    static bool callerSaved(int m) {
+        return isXmm(m) || (m != RBX && m != RBP && m < R12);
+    }
+
+    // 常驻寄存器与内存中的槽之间搬运
+    void saveResident(uint32_t r) {
+        int m = allocated[r];
+        if (isXmm(m)) {
+            emitRm(0xF2, false, {0x0F, 0x11}, m - XMM, memory(r));
+        } else {
+            emitRm(0, true, {0x89}, m, memory(r));
+        }
+    }
+
+    void loadResident(uint32_t r) {
+        int m = allocated[r];
+        if (isXmm(m)) {
+            emitRm(0xF2, false, {0x0F, 0x10}, m - XMM, memory(r));
+        } else {
+            emitRm(0, true, {0x8B}, m, memory(r));
+        }
+    }
+
+    // 调用运行时函数前把调用者保存的常驻寄存器写回内存，调用后重新装入
+    void spill() {
+        for (uint32_t r : residents) {
+            if (callerSaved(allocated[r])) saveResident(r);
+        }
+    }
+
+    void reload() {
+        for (uint32_t r : residents) {
+            if (callerSaved(allocated[r])) loadResident(r);
+        }
+    }
+
+    void call(const void* function) {
+        raxHolds = xmm0Holds = NOTHING;
+        emitRm(0, true, {0x8B}, RDI, reg(RBP)); // mov rdi, rbp（JitRuntime*）
+        movRegImm64(RAX, (uint64_t)(uintptr_t)function);
+        emitRm(0, false, {0xFF}, 2, reg(RAX)); // call rax
+    }
+
+    Operand memory(uint32_t r) const {
+        return {false, RBX, (int32_t)(r * 8)};
+    }
+
+    // 读入变量 slot：运行时函数直接写内存中的槽，失败时返回 0
+    void readSlot(const void* function, uint32_t slot) {
+        spill();
+        emitRm(0, true, {0x8D}, RSI, memory(slot)); // lea rsi, [rbx + 8 * slot]
+        byte(0xBA);                                   // mov edx, slot
+        imm32((int32_t)slot);
+        call(function);
+        reload();
+        if (allocated[slot] >= 0) loadResident(slot);
+        emitRm(0, false, {0x85}, RAX, reg(RAX)); // test eax, eax
+        jcc(CC_E, EXIT_TARGET | JIT_EXIT_ERROR);
+    }
+
+    // 输出变量 slot：调用者保存的常驻寄存器已写回内存，从内存取参数，避免被参数寄存器覆盖
+    void writeValue(const void* function, uint32_t slot, bool isFloat) {
+        spill();
+        int m = allocated[slot];
+        Operand value = m >= 0 && !callerSaved(m) ? reg(m) : memory(slot);
+        if (!isFloat) {
+            emitRm(0, true, {0x8B}, RSI, value);
+        } else if (value.direct) {
+            emitRm(0x66, true, {0x0F, 0x6E}, 0, value); // movq xmm0, r64
+        } else {
+            emitRm(0xF2, false, {0x0F, 0x10}, 0, value);
+        }
+        call(function);
+        reload();
+    }
+
+    // 只用通用寄存器指令访问的字节码寄存器可以常驻通用寄存器，只用 SSE 指令访问的可以常驻
+    // xmm 寄存器（两种都有的留在内存里）；按循环嵌套深度加权统计使用次数，各取最多的几个
+    void allocateRegisters() {
+        size_t count = bytecode.code.size();
+        vector<int> depth(count + 1, 0);
+        for (size_t i = 0; i < count; ++i) {
+            const Instr& instr = bytecode.code[i];
+            if (bytecodeIsJump(instr.op) && instr.a <= i) {
+                ++depth[instr.a];
+                --depth[i + 1];
+            }
+        }
+        vector<double> weight(bytecode.registerCount, 0.0);
+        vector<uint8_t> access(bytecode.registerCount, 0);
+        double scale = 1.0;
+        int level = 0;
+        for (size_t i = 0; i < count; ++i) {
+            level += depth[i];
+            scale = 1.0;
+            for (int d = 0; d < level && d < 6; ++d) scale *= 10.0;
+            const Instr& instr = bytecode.code[i];
+            uint32_t used[3];
+            int n = registerOperands(instr, used);
+            for (int k = 0; k < n; ++k) weight[used[k]] += scale;
+            markAccess(instr, access);
+        }
+
+        allocated.assign(bytecode.registerCount, -1);
+        vector<uint32_t> gprCandidates, xmmCandidates;
+        for (uint32_t r = 0; r < bytecode.constantBase; ++r) {
+            if (weight[r] == 0) continue;
+            if (access[r] == ACCESS_SSE) {
+                xmmCandidates.push_back(r);
+            } else if (access[r] != (ACCESS_GPR | ACCESS_SSE)) {
+                gprCandidates.push_back(r);
+            }
+        }
+        auto pick = [&](vector<uint32_t>& candidates, size_t limit) {
+            if (candidates.size() > limit) {
+                partial_sort(candidates.begin(), candidates.begin() + limit, candidates.end(),
+                             [&](uint32_t x, uint32_t y) { return weight[x] > weight[y]; });
+                candidates.resize(limit);
+            }
+        };
+        size_t gprCount = sizeof(GPR_ALLOCATABLE) / sizeof(GPR_ALLOCATABLE[0]);
+        pick(gprCandidates, gprCount);
+        pick(xmmCandidates, XMM_ALLOCATABLE);
+        for (size_t k = 0; k < gprCandidates.size(); ++k) {
+            allocated[gprCandidates[k]] = GPR_ALLOCATABLE[k];
+            residents.push_back(gprCandidates[k]);
+        }
+        for (size_t k = 0; k < xmmCandidates.size(); ++k) {
+            allocated[xmmCandidates[k]] = XMM + 2 + (int)k;
+            residents.push_back(xmmCandidates[k]);
+        }
+    }
+
+    // 指令读写的字节码寄存器
+    static int registerOperands(const Instr& instr, uint32_t used[3]) {
+        BytecodeOp op = instr.op;
+        if (op == BC_HALT || op == BC_JMP || op == BC_PUTC) return 0;
+        if (op == BC_JT || op == BC_JF) {
+            used[0] = instr.b;
+            return 1;
+        }
+        if ((op >= BC_JEQ_I && op <= BC_JNGE_F) || (op >= BC_INC_JLT_I && op <= BC_DEC_JGE_I)) {
+            used[0] = instr.b;
+            used[1] = instr.c;
+            return 2;
+        }
+        if (op >= BC_INC_I && op <= BC_DEC_F) {
+            used[0] = instr.a;
+            return 1;
+        }
+        if (op >= BC_READ_I && op <= BC_WRITE_B) {
+            used[0] = instr.a;
+            return 1;
+        }
+        used[0] = instr.a;
+        used[1] = instr.b;
+        if (op == BC_MOV || (op >= BC_NOT && op <= BC_F2B)) return 2;
+        used[2] = instr.c;
+        return 3;
+    }
+
+    // 各操作数的访问方式。MOV 两种方式都能搬运；读写经由内存中的槽，都不算
+    static void markAccess(const Instr& x, vector<uint8_t>& access) {
+        BytecodeOp op = x.op;
+        if (op == BC_MOV || op >= BC_READ_I) return;
+        if (op >= BC_ADD_F && op <= BC_DIV_F) {
+            access[x.a] |= ACCESS_SSE;
+            access[x.b] |= ACCESS_SSE;
+            access[x.c] |= ACCESS_SSE;
+        } else if (op >= BC_EQ_F && op <= BC_GE_F) {
+            access[x.a] |= ACCESS_GPR;
+            access[x.b] |= ACCESS_SSE;
+            access[x.c] |= ACCESS_SSE;
+        } else if ((op >= BC_JEQ_F && op <= BC_JGE_F) || (op >= BC_JNEQ_F && op <= BC_JNGE_F)) {
+            access[x.b] |= ACCESS_SSE;
+            access[x.c] |= ACCESS_SSE;
+        } else if (op == BC_I2F) {
+            access[x.a] |= ACCESS_SSE;
+            access[x.b] |= ACCESS_GPR;
+        } else if (op == BC_F2I || op == BC_F2B) {
+            access[x.a] |= ACCESS_GPR;
+            access[x.b] |= ACCESS_SSE;
+        } else if (op == BC_INC_F || op == BC_DEC_F) {
+            access[x.a] |= ACCESS_SSE;
+        } else {
+            uint32_t used[3];
+            int n = registerOperands(x, used);
+            for (int k = 0; k < n; ++k) access[used[k]] |= ACCESS_GPR;
+        }
+    }
+
+    void prologue() {
+        for (int r : {RBX, RBP, R12, R13, R14, R15}) {
+            if (r & 8) byte(0x41);
+            byte((uint8_t)(0x50 | (r & 7))); // push
+        }
+        emitRm(0, true, {0x83}, 5, reg(RSP)); // sub rsp, 8：调用运行时函数时栈按 16 字节对齐
+        byte(8);
+        emitRm(0, true, {0x8B}, RBX, reg(RDI)); // mov rbx, rdi
+        emitRm(0, true, {0x8B}, RBP, reg(RSI)); // mov rbp, rsi
+        for (uint32_t r : residents) loadResident(r);
+    }
+
+    // 出口：eax 是 JitExit，常驻寄存器写回内存后返回
+    void epilogue() {
+        for (uint32_t r : residents) saveResident(r);
+        emitRm(0, true, {0x83}, 0, reg(RSP)); // add rsp, 8
+        byte(8);
+        for (int r : {R15, R14, R13, R12, RBP, RBX}) {
+            if (r & 8) byte(0x41);
+            byte((uint8_t)(0x58 | (r & 7))); // pop
+        }
+        byte(0xC3);
+    }
+
+    // a = b 的 64 位值，两边可能分别在通用寄存器、xmm 寄存器或内存中
+    void move(uint32_t dst, uint32_t src) {
+        int md = allocated[dst], ms = allocated[src];
+        Operand d = operand(dst), o = operand(src);
+        int32_t value;
+        if (md >= 0 && isXmm(md)) {
+            if (ms >= 0 && isXmm(ms)) {
+                emitRm(0x66, false, {0x0F, 0x28}, d.reg, o);  // movapd
+            } else if (ms >= 0 || immediate(src, value)) {
+                load(RAX, src);
+                emitRm(0x66, true, {0x0F, 0x6E}, d.reg, reg(RAX)); // movq xmm, rax
+            } else {
+                emitRm(0xF2, false, {0x0F, 0x10}, d.reg, o);  // movsd xmm, m64
+            }
+        } else if (ms >= 0 && isXmm(ms)) {
+            if (md >= 0) {
+                emitRm(0x66, true, {0x0F, 0x7E}, o.reg, d);   // movq r64, xmm
+            } else {
+                emitRm(0xF2, false, {0x0F, 0x11}, o.reg, d);  // movsd m64, xmm
+            }
+        } else if (immediate(src, value)) {
+            emitRm(0, true, {0xC7}, 0, d);
+            imm32(value);
+        } else if (d.direct) {
+            load(d.reg, src);
+        } else {
+            int r = o.direct ? o.reg : RAX;
+            if (!o.direct) load(RAX, src);
+            store(dst, r);
+        }
+    }
+
+    void intBinary(const Instr& x) {
+        load(RAX, x.b);
+        switch (x.op) {
+        case BC_ADD_I:
+            alu(0x03, 0, RAX, x.c);
+            break;
+        case BC_SUB_I:
+            alu(0x2B, 5, RAX, x.c);
+            break;
+        default: {
+            int32_t value;
+            if (immediate(x.c, value)) {
+                emitRm(0, true, {0x69}, RAX, reg(RAX)); // imul rax, rax, imm32
+                imm32(value);
+            } else {
+                emitRm(0, true, {0x0F, 0xAF}, RAX, operand(x.c));
+            }
+            break;
+        }
+        }
+        store(x.a, RAX);
+        raxLeft = x.a;
+    }
+
+    // 整数除法：除数为 0 时退出，除数为 -1 时取负（避免 INT64_MIN / -1 触发异常）
+    void intDivide(const Instr& x) {
+        load(RAX, x.b);
+        load(RCX, x.c);
+        emitRm(0, true, {0x85}, RCX, reg(RCX)); // test rcx, rcx
+        jcc(CC_E, EXIT_TARGET | JIT_EXIT_DIV_ZERO);
+        emitRm(0, true, {0x83}, 7, reg(RCX));   // cmp rcx, -1
+        byte(0xFF);
+        size_t notMinusOne = jcc8(CC_NE);
+        emitRm(0, true, {0xF7}, 3, reg(RAX));   // neg rax
+        size_t done = jmp8();
+        bind8(notMinusOne);
+        byte(0x48);                             // cqo
+        byte(0x99);
+        emitRm(0, true, {0xF7}, 7, reg(RCX));   // idiv rcx
+        bind8(done);
+        store(x.a, RAX);
+    }
+
+    void floatBinary(const Instr& x) {
+        static const uint8_t opcodes[] = {0x58, 0x5C, 0x59, 0x5E}; // addsd subsd mulsd divsd
+        movsdLoad(0, x.b);
+        emitRm(0xF2, false, {0x0F, opcodes[x.op - BC_ADD_F]}, 0, operand(x.c));
+        movsdStore(x.a, 0);
+        xmm0Left = x.a;
+    }
+
+    // 整数比较的条件码：EQ NE LT LE GT GE
+    static Cond intCond(int k) {
+        static const Cond conds[] = {CC_E, CC_NE, CC_L, CC_LE, CC_G, CC_GE};
+        return conds[k];
+    }
+
+    static Cond negate(Cond cc) {
+        return (Cond)(cc ^ 1);
+    }
+
+    // float 比较：LT / LE 交换操作数后用 A / AE，NaN 时这些条件都不成立
+    void floatCompare(int k, uint32_t left, uint32_t right) {
+        if (k == 2 || k == 3) {
+            compareFloat(right, left);
+        } else {
+            compareFloat(left, right);
+        }
+    }
+
+    static Cond floatCond(int k) {
+        static const Cond conds[] = {CC_E, CC_NE, CC_A, CC_AE, CC_A, CC_AE};
+        return conds[k];
+    }
+
+    void floatCompareValue(const Instr& x) {
+        int k = x.op - BC_EQ_F;
+        floatCompare(k, x.b, x.c);
+        if (k == 0) {        // 相等且有序
+            setcc(CC_E);
+            setcc(CC_NP, RCX);
+            emitRm(0, false, {0x20}, RCX, reg(RAX)); // and al, cl
+        } else if (k == 1) { // 不等或无序
+            setcc(CC_NE);
+            setcc(CC_P, RCX);
+            emitRm(0, false, {0x08}, RCX, reg(RAX)); // or al, cl
+        } else {
+            setcc(floatCond(k));
+        }
+        boolResult(x.a);
+    }
+
+    // 条件成立（when 为 true）或不成立时跳转
+    void floatBranch(int k, bool when, uint32_t left, uint32_t right, uint32_t target) {
+        floatCompare(k, left, right);
+        bool equal = (k == 0) == when; // 跳转条件是"相等且有序"
+        if (k == 0 || k == 1) {
+            if (equal) {
+                size_t unordered = jcc8(CC_P);
+                jcc(CC_E, target);
+                bind8(unordered);
+            } else {
+                jcc(CC_P, target);
+                jcc(CC_NE, target);
+            }
+            return;
+        }
+        Cond cc = floatCond(k);
+        jcc(when ? cc : negate(cc), target);
+    }
+
+    void compileInstr(const Instr& x) {
+        BytecodeOp op = x.op;
+        switch (op) {
+        case BC_HALT:
+            emitRm(0, false, {0x31}, RAX, reg(RAX)); // xor eax, eax
+            jmp(EXIT_TARGET | JIT_EXIT_OK);
+            return;
+        case BC_MOV:
+            move(x.a, x.b);
+            return;
+        case BC_JMP:
+            jmp(x.a);
+            return;
+        case BC_JT:
+        case BC_JF: {
+            Operand o = operand(x.b);
+            if (!o.direct && raxHolds == x.b) o = reg(RAX);
+            if (o.direct) {
+                emitRm(0, true, {0x85}, o.reg, o); // test r, r
+            } else {
+                emitRm(0, true, {0x83}, 7, o);     // cmp qword [m], 0
+                byte(0);
+            }
+            jcc(op == BC_JT ? CC_NE : CC_E, x.a);
+            return;
+        }
+        case BC_ADD_I:
+        case BC_SUB_I:
+        case BC_MUL_I:
+            intBinary(x);
+            return;
+        case BC_DIV_I:
+            intDivide(x);
+            return;
+        case BC_ADD_F:
+        case BC_SUB_F:
+        case BC_MUL_F:
+        case BC_DIV_F:
+            floatBinary(x);
+            return;
+        case BC_EQ_B:
+        case BC_NE_B:
+            compareInt(x.b, x.c);
+            setcc(op == BC_EQ_B ? CC_E : CC_NE);
+            boolResult(x.a);
+            return;
+        case BC_NOT:
+            load(RAX, x.b);
+            emitRm(0, false, {0x83}, 6, reg(RAX)); // xor eax, 1
+            byte(1);
+            store(x.a, RAX);
+            raxLeft = x.a;
+            return;
+        case BC_NEG_I:
+            load(RAX, x.b);
+            emitRm(0, true, {0xF7}, 3, reg(RAX));
+            store(x.a, RAX);
+            raxLeft = x.a;
+            return;
+        case BC_NEG_F:
+            load(RAX, x.b);
+            emitRm(0, true, {0x0F, 0xBA}, 7, reg(RAX)); // btc rax, 63：翻转符号位
+            byte(63);
+            store(x.a, RAX);
+            return;
+        case BC_I2F:
+            load(RAX, x.b);
+            emitRm(0xF2, true, {0x0F, 0x2A}, 0, reg(RAX)); // cvtsi2sd xmm0, rax
+            movsdStore(x.a, 0);
+            xmm0Left = x.a;
+            return;
+        case BC_F2I: {
+            // cvttsd2si 越界和 NaN 时得到 INT64_MIN；只有原值恰好是 -2^63 时才是合法结果
+            emitRm(0xF2, true, {0x0F, 0x2C}, RAX, operand(x.b));
+            movRegImm64(RCX, 0x8000000000000000ull);
+            emitRm(0, true, {0x3B}, RAX, reg(RCX));
+            size_t inRange = jcc8(CC_NE);
+            movRegImm64(RCX, 0xC3E0000000000000ull); // -2^63 的位模式
+            if (operand(x.b).direct) {
+                emitRm(0x66, true, {0x0F, 0x7E}, operand(x.b).reg, reg(RDX)); // movq rdx, xmm
+                emitRm(0, true, {0x3B}, RCX, reg(RDX));
+            } else {
+                emitRm(0, true, {0x3B}, RCX, operand(x.b));
+            }
+            jcc(CC_NE, EXIT_TARGET | JIT_EXIT_FLOAT_RANGE);
+            bind8(inRange);
+            store(x.a, RAX);
+            return;
+        }
+        case BC_I2B: {
+            Operand o = operand(x.b);
+            if (o.direct) {
+                emitRm(0, true, {0x85}, o.reg, o);
+            } else {
+                emitRm(0, true, {0x83}, 7, o);
+                byte(0);
+            }
+            setcc(CC_NE);
+            boolResult(x.a);
+            return;
+        }
+        case BC_F2B:
+            movsdLoad(0, x.b);
+            emitRm(0x66, false, {0x0F, 0x57}, 1, reg(1)); // xorpd xmm1, xmm1
+            emitRm(0x66, false, {0x0F, 0x2E}, 0, reg(1)); // ucomisd xmm0, xmm1
+            setcc(CC_NE);
+            setcc(CC_P, RCX);
+            emitRm(0, false, {0x08}, RCX, reg(RAX));      // or al, cl
+            boolResult(x.a);
+            return;
+        case BC_INC_I:
+        case BC_DEC_I:
+            emitRm(0, true, {0xFF}, op == BC_INC_I ? 0 : 1, operand(x.a));
+            updatedInPlace(x.a);
+            return;
+        case BC_INC_F:
+        case BC_DEC_F:
+            movsdLoad(0, x.a);
+            movRegImm64(RAX, 0x3FF0000000000000ull);           // 1.0
+            emitRm(0x66, true, {0x0F, 0x6E}, 1, reg(RAX));     // movq xmm1, rax
+            emitRm(0xF2, false, {0x0F, (uint8_t)(op == BC_INC_F ? 0x58 : 0x5C)}, 0, reg(1));
+            movsdStore(x.a, 0);
+            return;
+        case BC_INC_JLT_I:
+        case BC_INC_JLE_I:
+        case BC_DEC_JGT_I:
+        case BC_DEC_JGE_I: {
+            bool inc = op == BC_INC_JLT_I || op == BC_INC_JLE_I;
+            emitRm(0, true, {0xFF}, inc ? 0 : 1, operand(x.b));
+            updatedInPlace(x.b);
+            compareInt(x.b, x.c);
+            static const Cond conds[] = {CC_L, CC_LE, CC_G, CC_GE};
+            jcc(conds[op - BC_INC_JLT_I], x.a);
+            return;
+        }
+        case BC_READ_I:
+            readSlot((const void*)&jitReadInt, x.a);
+            return;
+        case BC_READ_F:
+            readSlot((const void*)&jitReadFloat, x.a);
+            return;
+        case BC_READ_B:
+            readSlot((const void*)&jitReadBool, x.a);
+            return;
+        case BC_WRITE_I:
+            writeValue((const void*)&jitWriteInt, x.a, false);
+            return;
+        case BC_WRITE_F:
+            writeValue((const void*)&jitWriteFloat, x.a, true);
+            return;
+        case BC_WRITE_B:
+            writeValue((const void*)&jitWriteBool, x.a, false);
+            return;
+        case BC_PUTC:
+            spill();
+            byte(0xBE); // mov esi, c
+            imm32((int32_t)x.a);
+            call((const void*)&jitPutChar);
+            reload();
+            return;
+        default:
+            break;
+        }
+
+        if (op >= BC_EQ_I && op <= BC_GE_I) {
+            compareInt(x.b, x.c);
+            setcc(intCond(op - BC_EQ_I));
+            boolResult(x.a);
+        } else if (op >= BC_EQ_F && op <= BC_GE_F) {
+            floatCompareValue(x);
+        } else if (op >= BC_JEQ_I && op <= BC_JGE_I) {
+            compareInt(x.b, x.c);
+            jcc(intCond(op - BC_JEQ_I), x.a);
+        } else if (op >= BC_JNEQ_I && op <= BC_JNGE_I) {
+            compareInt(x.b, x.c);
+            jcc(negate(intCond(op - BC_JNEQ_I)), x.a);
+        } else if (op >= BC_JEQ_F && op <= BC_JGE_F) {
+            floatBranch(op - BC_JEQ_F, true, x.b, x.c, x.a);
+        } else {
+            floatBranch(op - BC_JNEQ_F, false, x.b, x.c, x.a);
+        }
+    }
+
+public:
+    explicit JitCompiler(const Bytecode& b) : bytecode(b) {}
+
+    // 生成整个程序的机器码，不支持时返回 false 并给出原因
+    bool compile(vector<uint8_t>& out, string& reason) {
+        if ((uint64_t)bytecode.registerCount * 8 > (uint64_t)INT32_MAX) {
+            reason = "too many registers";
+            return false;
+        }
+        for (const Instr& instr : bytecode.code) {
+            if (instr.op >= BC_COUNT) {
+                reason = string("unsupported instruction ") + bytecodeOpName(instr.op);
+                return false;
+            }
+        }
+        allocateRegisters();
+        prologue();
+        vector<bool> jumpTarget(bytecode.code.size() + 1, false);
+        for (const Instr& instr : bytecode.code) {
+            if (bytecodeIsJump(instr.op)) jumpTarget[instr.a] = true;
+        }
+        offsets.resize(bytecode.code.size());
+        for (size_t i = 0; i < bytecode.code.size(); ++i) {
+            offsets[i] = code.size();
+            raxHolds = jumpTarget[i] ? NOTHING : raxLeft;
+            xmm0Holds = jumpTarget[i] ? NOTHING : xmm0Left;
+            raxLeft = xmm0Left = NOTHING;
+            compileInstr(bytecode.code[i]);
+        }
+
+        // 各出口：eax = 退出码，然后进入公共的收尾代码
+        size_t exits[4];
+        size_t toEpilogue[3];
+        for (int k = 0; k < 4; ++k) {
+            exits[k] = code.size();
+            byte(0xB8); // mov eax, k
+            imm32(k);
+            if (k < 3) toEpilogue[k] = jmp8();
+        }
+        for (size_t after : toEpilogue) bind8(after);
+        epilogue();
+
+        for (const Fixup& f : fixups) {
+            size_t target = (f.target & EXIT_TARGET) ? exits[f.target & ~EXIT_TARGET] : offsets[f.target];
+            int32_t rel = (int32_t)((int64_t)target - (int64_t)(f.at + 4));
+            memcpy(&code[f.at], &rel, sizeof(rel));
+        }
+        out.swap(code);
+        return true;
+    }
+};
+
+#endif // JIT_AVAILABLE
+
+// 用 JIT 执行字节码程序；compile 失败（不是 x86-64 Linux、无法映射可执行内存等）时
+// 调用方应退回字节码虚拟机
+class JitRunner {
+private:
+    const Bytecode& bytecode;
+    BufferedInput& input;
+    BufferedOutput& output;
+#if JIT_AVAILABLE
+    NativeCode native;
+#endif
+
+public:
+    JitRunner(const Bytecode& code, BufferedInput& in, BufferedOutput& out)
+        : bytecode(code), input(in), output(out) {}
+
+    bool compile(string& reason) {
+#if JIT_AVAILABLE
+        vector<uint8_t> machineCode;
+        JitCompiler compiler(bytecode);
+        if (!compiler.compile(machineCode, reason)) return false;
+        return native.load(machineCode, reason);
+#else
+        reason = "JIT needs x86-64 Linux";
+        return false;
+#endif
+    }
+
+    // 执行整个程序，运行时错误时返回 false，error 给出原因（之前的输出已写出）
+    bool run(string& error) {
+#if JIT_AVAILABLE
+        vector<Value> registers(bytecode.registerCount, Value{});
+        for (size_t i = 0; i < bytecode.constants.size(); ++i) {
+            registers[bytecode.constantBase + i] = bytecode.constants[i];
+        }
+        JitRuntime runtime = {&input, &output, &bytecode, ""};
+        int exit = native.entry()(registers.data(), &runtime);
+        output.flush();
+        switch (exit) {
+        case JIT_EXIT_OK:          return true;
+        case JIT_EXIT_ERROR:       error = runtime.error; return false;
+        case JIT_EXIT_DIV_ZERO:    error = "Division by zero"; return false;
+        default:                   error = "Float value out of int range"; return false;
+        }
+#else
+        error = "JIT needs x86-64 Linux";
+        return false;
+#endif
+    }
+};
+
+#endif // JIT_H
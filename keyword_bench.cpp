@@ -0,0 +1,105 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include "lexer.h"
+using namespace std;
+
+// 原先的关键字符号表（用作对照）
+unordered_map<string, TokenType> keywordMap = {
+    {"int", TOKEN_KEYWORD},
+    {"float", TOKEN_KEYWORD},
+    {"bool", TOKEN_KEYWORD},
+    {"if", TOKEN_KEYWORD},
+    {"else", TOKEN_KEYWORD},
+    {"while", TOKEN_KEYWORD},
+    {"for", TOKEN_KEYWORD},
+    {"read", TOKEN_KEYWORD},
+    {"write", TOKEN_KEYWORD},
+    {"true", TOKEN_BOOL},
+    {"false", TOKEN_BOOL}
+};
+
+// 原先 recognizeIdOrKeyword 的查找方式：构造 string，find 之后再 operator[]
+TokenType classifyWithMap(string_view id) {
+    string value(id);
+    if (keywordMap.find(value) != keywordMap.end()) {
+        return keywordMap[value];
+    }
+    return TOKEN_ID;
+}
+
+// 没有指定输入文件时生成以标识符为主的源程序
+string makeIdentifierHeavySource(size_t count) {
+    const char* words[] = {
+        "a", "i", "count", "total_sum", "x1", "pi", "flag", "int", "float", "while",
+        "write", "whilst", "iff", "floats", "true", "false", "veryLongIdentifierName_42", "for", "read", "bool"
+    };
+    string source;
+    unsigned seed = 12345;
+    for (size_t i = 0; i < count; ++i) {
+        seed = seed * 1103515245 + 12345;
+        source += words[(seed >> 16) % (sizeof(words) / sizeof(words[0]))];
+        source += ' ';
+    }
+    return source;
+}
+
+template <typename Classify>
+void runBench(const char* name, const vector<string_view>& ids, int rounds, Classify classify) {
+    size_t checksum = 0;
+    auto begin = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (string_view id : ids) checksum += classify(id);
+    }
+    auto end = chrono::steady_clock::now();
+    double ns = chrono::duration<double, nano>(end - begin).count() / (double(ids.size()) * rounds);
+    cout << name << ": " << ns << " ns/lookup (checksum " << checksum << ")" << endl;
+}
+
+// 关键字识别微基准：原 unordered_map 与完美哈希对比
+// 用法：keyword_bench [源程序文件]
+int main(int argc, char* argv[]) {
+    string source;
+    if (argc > 1) {
+        ifstream inFile(argv[1]);
+        if (!inFile) {
+            cerr << "can't open " << argv[1] << endl;
+            return 1;
+        }
+        source.assign(istreambuf_iterator<char>(inFile), istreambuf_iterator<char>());
+    } else {
+        source = makeIdentifierHeavySource(1000000);
+    }
+
+    // 收集所有标识符、关键字和布尔常量
+    Lexer lexer(source);
+    vector<string_view> ids;
+    while (true) {
+        Token token = lexer.getNextToken();
+        if (token.type == TOKEN_ERROR && token.value.empty()) break;
+        if (token.type == TOKEN_ID || token.type == TOKEN_KEYWORD || token.type == TOKEN_BOOL) {
+            ids.push_back(token.value);
+        }
+    }
+    if (ids.empty()) {
+        cerr << "no identifiers in input" << endl;
+        return 1;
+    }
+
+    // 两种实现的结果必须一致
+    for (string_view id : ids) {
+        if (classifyWithMap(id) != classifyIdentifier(id)) {
+            cerr << "mismatch on identifier: " << id << endl;
+            return 1;
+        }
+    }
+
+    int rounds = int(20000000 / ids.size()) + 1;
+    cout << ids.size() << " identifiers x " << rounds << " rounds" << endl;
+    runBench("unordered_map", ids, rounds, classifyWithMap);
+    runBench("perfect hash ", ids, rounds, classifyIdentifier);
+    return 0;
+}
@@ -0,0 +1,532 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "interner.h"
+#include "simd_scan.h"
+using namespace std;
+
+// 单词符号类型编码
+enum TokenType {
+    TOKEN_ID,        // 标识符
+    TOKEN_NUM,       // 整常数
+    TOKEN_FLOAT,     // 浮点数
+    TOKEN_BOOL,      // 布尔常量
+    TOKEN_KEYWORD,   // 关键字
+    TOKEN_OP,        // 运算符
+    TOKEN_SEP,       // 分隔符
+    TOKEN_ERROR      // 错误
+};
+
+// 词法错误类别（诊断信息不再拼接进单词符号的值）
+enum LexError {
+    LEX_OK,            // 无错误
+    LEX_ILLEGAL_ID,    // 非法标识符
+    LEX_ILLEGAL_FMT,   // 非法格式
+    LEX_ILLEGAL_SYM,   // 非法符号
+    LEX_ILLEGAL_CHAR,  // 非法字符
+    LEX_INT_RANGE,     // 整常数超出 int64 范围
+    LEX_FLOAT_RANGE    // 浮点数上溢为无穷大或下溢为零
+};
+
+// 错误类别对应的诊断前缀
+inline const char* lexErrorText(LexError error) {
+    switch (error) {
+    case LEX_ILLEGAL_ID:   return "Illegal identifiers: ";
+    case LEX_ILLEGAL_FMT:  return "Illegal formatting: ";
+    case LEX_ILLEGAL_SYM:  return "Illegal symbols: ";
+    case LEX_ILLEGAL_CHAR: return "Illegal characters: ";
+    case LEX_INT_RANGE:    return "Integer out of range: ";
+    case LEX_FLOAT_RANGE:  return "Float out of range: ";
+    default:               return "";
+    }
+}
+
+// 关键字、运算符和分隔符的细分类别，每个取值对应唯一的拼写，
+// 语法分析器据此做整数比较而不再比较字符串
+enum TokenKind : unsigned char {
+    KIND_NONE,   // 标识符、常数、错误
+    // 关键字与布尔常量
+    KW_INT, KW_FLOAT, KW_BOOL, KW_IF, KW_ELSE, KW_WHILE, KW_FOR, KW_READ, KW_WRITE,
+    KW_TRUE, KW_FALSE,
+    // 运算符
+    OP_PLUS,     // +
+    OP_MINUS,    // -
+    OP_MUL,      // *
+    OP_DIV,      // /
+    OP_ASSIGN,   // =
+    OP_BITAND,   // &
+    OP_BITOR,    // |
+    OP_EQ,       // ==
+    OP_NE,       // !=
+    OP_LT,       // <
+    OP_LE,       // <=
+    OP_GT,       // >
+    OP_GE,       // >=
+    OP_AND,      // &&
+    OP_OR,       // ||
+    OP_NOT,      // !
+    OP_INC,      // ++
+    OP_DEC,      // --
+    // 分隔符
+    SEP_SEMI,    // ;
+    SEP_COMMA,   // ,
+    SEP_LPAREN,  // (
+    SEP_RPAREN,  // )
+    SEP_LBRACE,  // {
+    SEP_RBRACE,  // }
+    KIND_COUNT
+};
+
+// 符号表：关键字
+//   int float bool if else while for read write -> TOKEN_KEYWORD
+//   true false -> TOKEN_BOOL
+// 关键字最长 5 个字节，按小端序装进一个 uint64_t，用首字符、次字符和长度做完美哈希，
+// 查表后只需一次 64 位比较即可判定
+struct KeywordSlot {
+    uint64_t word;   // 关键字的字节打包值，0 表示空槽
+    TokenType type;
+    TokenKind kind;
+};
+
+constexpr size_t KEYWORD_MAX_LEN = 5;
+constexpr size_t KEYWORD_TABLE_SIZE = 16;
+
+constexpr uint64_t packKeyword(const char* text, size_t len) {
+    uint64_t word = 0;
+    for (size_t i = 0; i < len; ++i) {
+        word |= uint64_t((unsigned char)text[i]) << (8 * i);
+    }
+    return word;
+}
+
+constexpr size_t keywordHash(const char* text, size_t len) {
+    return ((unsigned char)text[0] * 7 + (unsigned char)text[1] * 2 + len) & (KEYWORD_TABLE_SIZE - 1);
+}
+
+constexpr array<KeywordSlot, KEYWORD_TABLE_SIZE> makeKeywordTable() {
+    struct Entry { const char* text; size_t len; TokenType type; TokenKind kind; };
+    constexpr Entry entries[] = {
+        {"int", 3, TOKEN_KEYWORD, KW_INT},
+        {"float", 5, TOKEN_KEYWORD, KW_FLOAT}, // 新增 float
+        {"bool", 4, TOKEN_KEYWORD, KW_BOOL},
+        {"if", 2, TOKEN_KEYWORD, KW_IF},
+        {"else", 4, TOKEN_KEYWORD, KW_ELSE},
+        {"while", 5, TOKEN_KEYWORD, KW_WHILE},
+        {"for", 3, TOKEN_KEYWORD, KW_FOR}, // 新增 for
+        {"read", 4, TOKEN_KEYWORD, KW_READ},
+        {"write", 5, TOKEN_KEYWORD, KW_WRITE},
+        {"true", 4, TOKEN_BOOL, KW_TRUE},
+        {"false", 5, TOKEN_BOOL, KW_FALSE}
+    };
+    array<KeywordSlot, KEYWORD_TABLE_SIZE> table{};
+    for (const Entry& e : entries) {
+        KeywordSlot& slot = table[keywordHash(e.text, e.len)];
+        if (slot.word != 0) throw "keyword hash collision"; // 编译期报错
+        slot = {packKeyword(e.text, e.len), e.type, e.kind};
+    }
+    return table;
+}
+
+constexpr auto keywordTable = makeKeywordTable();
+
+// 查找关键字，不是关键字时返回 nullptr
+inline const KeywordSlot* findKeyword(string_view id) {
+    if (id.size() < 2 || id.size() > KEYWORD_MAX_LEN) return nullptr;
+    const KeywordSlot& slot = keywordTable[keywordHash(id.data(), id.size())];
+    return packKeyword(id.data(), id.size()) == slot.word ? &slot : nullptr;
+}
+
+// 判定标识符是否为关键字，返回 TOKEN_KEYWORD / TOKEN_BOOL / TOKEN_ID
+inline TokenType classifyIdentifier(string_view id) {
+    const KeywordSlot* slot = findKeyword(id);
+    return slot ? slot->type : TOKEN_ID;
+}
+
+// 符号表：运算符和分隔符已编码进下面的字符类别表与 DFA 转移表
+//   运算符：+ - * / = & | == != < <= > >= && || ! ++ --
+//   分隔符：; , ( ) { }
+
+// 字符类别
+enum CharClass : unsigned char {
+    CC_OTHER,   // 非法字符
+    CC_SPACE,   // 空白字符
+    CC_LETTER,  // 字母或下划线
+    CC_DIGIT,   // 数字
+    CC_DOT,     // 小数点
+    CC_EQ,      // =
+    CC_CMP,     // ! < >（后面可接 = 组成双字符运算符）
+    CC_AMP,     // &
+    CC_PIPE,    // |
+    CC_PLUS,    // +
+    CC_MINUS,   // -
+    CC_OP,      // * /（只有单字符形式）
+    CC_SEP,     // ; , ( ) { }
+    CC_EOF,     // 输入结束（不对应任何字符）
+    CC_COUNT
+};
+
+// DFA 状态
+enum DfaState : unsigned char {
+    S_START,    // 初始状态
+    S_ID,       // 标识符
+    S_INT,      // 整数部分
+    S_DOT1,     // 刚读过第一个小数点
+    S_FRAC,     // 小数部分
+    S_DOT2,     // 读到多余的小数点（非法格式）
+    S_BADTAIL,  // 数字后接字母或下划线（非法格式）
+    S_OP_EQ,    // = ! < >，可再接 =
+    S_AMP,      // &，可再接 &
+    S_PIPE,     // |，可再接 |
+    S_PLUS,     // +，可再接 +
+    S_MINUS,    // -，可再接 -
+    S_OP,       // 完整的运算符
+    S_SEP,      // 完整的分隔符
+    S_BAD,      // 非法字符
+    S_DONE,     // 单词符号结束（不消耗当前字符）
+    S_COUNT
+};
+
+constexpr array<unsigned char, 256> makeCharClass() {
+    array<unsigned char, 256> table{};
+    for (int c = 'a'; c <= 'z'; ++c) table[c] = CC_LETTER;
+    for (int c = 'A'; c <= 'Z'; ++c) table[c] = CC_LETTER;
+    for (int c = '0'; c <= '9'; ++c) table[c] = CC_DIGIT;
+    table['_'] = CC_LETTER;
+    table[' '] = table['\t'] = table['\n'] = CC_SPACE;
+    table['\v'] = table['\f'] = table['\r'] = CC_SPACE;
+    table['.'] = CC_DOT;
+    table['='] = CC_EQ;
+    table['!'] = table['<'] = table['>'] = CC_CMP;
+    table['&'] = CC_AMP;
+    table['|'] = CC_PIPE;
+    table['+'] = CC_PLUS;
+    table['-'] = CC_MINUS;
+    table['*'] = table['/'] = CC_OP;
+    table[';'] = table[','] = table['('] = table[')'] = table['{'] = table['}'] = CC_SEP;
+    return table;
+}
+
+constexpr array<array<unsigned char, CC_COUNT>, S_COUNT> makeDfa() {
+    array<array<unsigned char, CC_COUNT>, S_COUNT> dfa{};
+    for (auto& row : dfa) {
+        for (auto& next : row) next = S_DONE;
+    }
+
+    // 初始状态按首字符分派
+    for (auto& next : dfa[S_START]) next = S_BAD;
+    dfa[S_START][CC_LETTER] = S_ID;
+    dfa[S_START][CC_DIGIT] = S_INT;
+    dfa[S_START][CC_EQ] = dfa[S_START][CC_CMP] = S_OP_EQ;
+    dfa[S_START][CC_AMP] = S_AMP;
+    dfa[S_START][CC_PIPE] = S_PIPE;
+    dfa[S_START][CC_PLUS] = S_PLUS;
+    dfa[S_START][CC_MINUS] = S_MINUS;
+    dfa[S_START][CC_OP] = S_OP;
+    dfa[S_START][CC_SEP] = S_SEP;
+    dfa[S_START][CC_EOF] = S_DONE;
+
+    // 标识符
+    dfa[S_ID][CC_LETTER] = dfa[S_ID][CC_DIGIT] = S_ID;
+
+    // 整常数与浮点数，非法格式会一直读到字母数字串结束
+    dfa[S_INT][CC_DIGIT] = S_INT;
+    dfa[S_INT][CC_DOT] = S_DOT1;
+    dfa[S_INT][CC_LETTER] = S_BADTAIL;
+    dfa[S_DOT1][CC_DIGIT] = S_FRAC;
+    dfa[S_DOT1][CC_DOT] = S_DOT2;
+    dfa[S_DOT1][CC_LETTER] = S_BADTAIL;
+    dfa[S_FRAC][CC_DIGIT] = S_FRAC;
+    dfa[S_FRAC][CC_DOT] = S_DOT2;
+    dfa[S_FRAC][CC_LETTER] = S_BADTAIL;
+    dfa[S_DOT2][CC_DIGIT] = S_DOT2;
+    dfa[S_DOT2][CC_LETTER] = S_BADTAIL;
+    dfa[S_BADTAIL][CC_LETTER] = dfa[S_BADTAIL][CC_DIGIT] = S_BADTAIL;
+
+    // 双字符运算符
+    dfa[S_OP_EQ][CC_EQ] = S_OP;
+    dfa[S_AMP][CC_AMP] = S_OP;
+    dfa[S_PIPE][CC_PIPE] = S_OP;
+    dfa[S_PLUS][CC_PLUS] = S_OP;
+    dfa[S_MINUS][CC_MINUS] = S_OP;
+    return dfa;
+}
+
+// 终止状态对应的单词符号类型与错误类别
+struct DfaAccept {
+    TokenType type;
+    LexError error;
+};
+
+constexpr array<DfaAccept, S_COUNT> makeAccept() {
+    array<DfaAccept, S_COUNT> accept{};
+    for (auto& a : accept) a = {TOKEN_ERROR, LEX_ILLEGAL_CHAR};
+    accept[S_ID] = {TOKEN_ID, LEX_OK};
+    accept[S_INT] = {TOKEN_NUM, LEX_OK};
+    accept[S_FRAC] = {TOKEN_FLOAT, LEX_OK};
+    accept[S_DOT1] = accept[S_DOT2] = accept[S_BADTAIL] = {TOKEN_ERROR, LEX_ILLEGAL_FMT};
+    accept[S_OP_EQ] = accept[S_AMP] = accept[S_PIPE] = {TOKEN_OP, LEX_OK};
+    accept[S_PLUS] = accept[S_MINUS] = accept[S_OP] = {TOKEN_OP, LEX_OK};
+    accept[S_SEP] = {TOKEN_SEP, LEX_OK};
+    return accept;
+}
+
+// 自环状态可用批量扫描函数一次跳过的字符串类别
+enum DfaRun : unsigned char {
+    RUN_NONE,
+    RUN_IDENT,  // [A-Za-z0-9_]*
+    RUN_DIGIT   // [0-9]*
+};
+
+constexpr array<unsigned char, S_COUNT> makeRun() {
+    array<unsigned char, S_COUNT> run{};
+    run[S_ID] = run[S_BADTAIL] = RUN_IDENT;
+    run[S_INT] = run[S_FRAC] = run[S_DOT2] = RUN_DIGIT;
+    return run;
+}
+
+// 运算符和分隔符的细分类别：按首字符和长度查表（双字符运算符的第二个字符由首字符唯一确定）
+constexpr array<array<unsigned char, 2>, 256> makeSymbolKind() {
+    array<array<unsigned char, 2>, 256> table{};
+    table['+'] = {OP_PLUS, OP_INC};
+    table['-'] = {OP_MINUS, OP_DEC};
+    table['*'][0] = OP_MUL;
+    table['/'][0] = OP_DIV;
+    table['='] = {OP_ASSIGN, OP_EQ};
+    table['&'] = {OP_BITAND, OP_AND};
+    table['|'] = {OP_BITOR, OP_OR};
+    table['!'] = {OP_NOT, OP_NE};
+    table['<'] = {OP_LT, OP_LE};
+    table['>'] = {OP_GT, OP_GE};
+    table[';'][0] = SEP_SEMI;
+    table[','][0] = SEP_COMMA;
+    table['('][0] = SEP_LPAREN;
+    table[')'][0] = SEP_RPAREN;
+    table['{'][0] = SEP_LBRACE;
+    table['}'][0] = SEP_RBRACE;
+    return table;
+}
+
+constexpr auto charClass = makeCharClass();
+constexpr auto dfa = makeDfa();
+constexpr auto dfaAccept = makeAccept();
+constexpr auto dfaRun = makeRun();
+constexpr auto symbolKind = makeSymbolKind();
+
+// 由单词符号的类型和拼写求细分类别（读取文本格式的单词符号文件时使用）
+inline TokenKind tokenKind(TokenType type, string_view value) {
+    if (type == TOKEN_KEYWORD || type == TOKEN_BOOL) {
+        const KeywordSlot* slot = findKeyword(value);
+        return slot ? slot->kind : KIND_NONE;
+    }
+    if ((type == TOKEN_OP || type == TOKEN_SEP) && (value.size() == 1 || value.size() == 2)) {
+        return (TokenKind)symbolKind[(unsigned char)value[0]][value.size() - 1];
+    }
+    return KIND_NONE;
+}
+
+// 常数的值：TOKEN_NUM 用 i，TOKEN_FLOAT 用 f
+union Literal {
+    int64_t i;
+    double f;
+};
+
+// 单词符号的二元组
+struct Token {
+    TokenType type;
+    string_view value;       // 源程序缓冲区中的切片，不拥有内存
+    LexError error = LEX_OK; // 错误类别，仅 TOKEN_ERROR 使用
+    TokenKind kind = KIND_NONE; // 关键字、运算符、分隔符的细分类别
+    uint32_t symbol = 0;     // 标识符和常量在驻留表中的编号，0 表示没有驻留
+    Literal literal = {};    // 常数的值，词法分析时转换一次
+};
+
+// 把常数的文本（TOKEN_NUM 为十进制数字串，TOKEN_FLOAT 为"数字.数字"）转换成值。
+// 超出范围时返回 TOKEN_ERROR 和对应的错误类别，不会静默截断
+inline Token numberToken(TokenType type, string_view value) {
+    const char* first = value.data();
+    const char* last = first + value.size();
+    Token token = {type, value};
+    if (type == TOKEN_NUM) {
+        // 18 位以内不会超出 int64，逐位累加，不必调用 from_chars
+        if (value.size() <= 18) {
+            int64_t n = 0;
+            for (const char* p = first; p < last; ++p) n = n * 10 + (*p - '0');
+            token.literal.i = n;
+            return token;
+        }
+        if (from_chars(first, last, token.literal.i).ec == errc()) return token;
+        return {TOKEN_ERROR, value, LEX_INT_RANGE};
+    }
+    if (from_chars(first, last, token.literal.f).ec == errc()) return token;
+    return {TOKEN_ERROR, value, LEX_FLOAT_RANGE};
+}
+
+// 扫描位置所处的注释（流式分析时注释可能跨越缓冲区边界）
+enum CommentState {
+    COMMENT_NONE,
+    COMMENT_LINE,   // 单行注释 //
+    COMMENT_BLOCK   // 块注释 /* */
+};
+
+// 词法分析器
+class Lexer {
+private:
+    string_view source; // 源程序（不拥有内存，可以是 mmap 映射区）
+    size_t pos = 0; // 当前扫描位置
+    bool final = true; // source 之后是否已没有更多输入
+    bool incomplete = false; // 上一次扫描是否因缓冲区结束而中断
+    CommentState comment = COMMENT_NONE;
+
+    ScanKernels kernels = scanKernels(); // 按 CPU 选定的批量扫描函数
+    StringInterner* symbols = nullptr; // 标识符和常量的驻留表，为空时不驻留
+
+    // 跳过空白字符和注释，连续的空白与注释一次跳完；
+    // 注释到缓冲区末尾仍未结束时 comment 保持非 COMMENT_NONE
+    void skipWhitespace() {
+        const char* text = source.data();
+        const char* end = text + source.length();
+        const char* p = text + pos;
+        while (true) {
+            if (comment == COMMENT_LINE) {
+                // 单行注释，跳到行尾的换行符
+                const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+                if (!newline) {
+                    p = end;
+                    break;
+                }
+                p = newline;
+                comment = COMMENT_NONE;
+            } else if (comment == COMMENT_BLOCK) {
+                // 块注释，未闭合时一直到文件结束
+                const char* close = kernels.findCommentEnd(p, end);
+                if (close == end) {
+                    // 末尾的 '*' 可能和下一块开头的 '/' 组成结束符，留到下一块
+                    p = (!final && p < end && end[-1] == '*') ? end - 1 : end;
+                    break;
+                }
+                p = close + 2;
+                comment = COMMENT_NONE;
+            }
+
+            // 单个空白字符最常见，内联处理；更长的空白串交给批量扫描函数
+            if (p < end && isSpaceByte(*p)) {
+                ++p;
+                if (p < end && isSpaceByte(*p)) p = kernels.skipSpaces(p, end);
+            }
+            if (end - p < 2 || p[0] != '/') break;
+            if (p[1] == '/') {
+                comment = COMMENT_LINE;
+            } else if (p[1] == '*') {
+                comment = COMMENT_BLOCK;
+            } else {
+                break;
+            }
+            p += 2;
+        }
+        pos = (size_t)(p - text);
+    }
+
+    // 取 [start, pos) 之间的源程序切片
+    string_view slice(size_t start) const {
+        return source.substr(start, pos - start);
+    }
+
+    uint32_t intern(string_view value) {
+        return symbols ? symbols->intern(value) : 0;
+    }
+
+public:
+    // 源程序缓冲区由调用方持有，必须比 Lexer 及其产生的单词符号活得更久；
+    // isFinal 为 false 表示 src 只是输入的一部分，后面还会通过 reset 接上
+    Lexer(string_view src, bool isFinal = true) : source(src), final(isFinal) {}
+
+    // 换到下一块缓冲区继续分析，注释状态保留
+    void reset(string_view src, bool isFinal) {
+        source = src;
+        pos = 0;
+        final = isFinal;
+        incomplete = false;
+    }
+
+    // 上一次 getNextToken 是否因缓冲区结束而没有得到完整的单词符号，
+    // 此时需要把 position() 之后的内容接上后续输入再重新扫描
+    bool needMore() const {
+        return incomplete;
+    }
+
+    size_t position() const {
+        return pos;
+    }
+
+    // 把标识符和常量驻留进 table，单词符号的 symbol 给出编号。
+    // table 不加锁，只能由调用 getNextToken 的线程使用
+    void internSymbols(StringInterner& table) {
+        symbols = &table;
+    }
+
+    // 从注释内部开始分析（并行分析时切分点可能落在块注释中间）
+    void setCommentState(CommentState state) {
+        comment = state;
+    }
+
+    // 获取下一个单词符号（value 指向源程序缓冲区）
+    Token getNextToken() {
+        incomplete = false;
+        skipWhitespace();
+        if (comment != COMMENT_NONE || pos >= source.length()) {
+            incomplete = !final;
+            return {TOKEN_ERROR, ""};
+        }
+
+        // 由转移表驱动的扫描循环，遇到 S_DONE 时当前字符不属于本单词符号
+        const char* text = source.data();
+        size_t length = source.length();
+        size_t start = pos;
+        unsigned char state = S_START;
+        while (true) {
+            unsigned char cls = pos < length ? charClass[(unsigned char)text[pos]] : (unsigned char)CC_EOF;
+            unsigned char next = dfa[state][cls];
+            if (next == S_DONE) break;
+            state = next;
+            ++pos;
+            // 自环状态的后续字符与转移表一致，直接整段跳过
+            if (dfaRun[state] == RUN_IDENT) {
+                pos = (size_t)(kernels.skipIdent(text + pos, text + length) - text);
+            } else if (dfaRun[state] == RUN_DIGIT) {
+                pos = (size_t)(kernels.skipDigits(text + pos, text + length) - text);
+            }
+        }
+
+        // 单词符号一直延伸到缓冲区末尾，后续输入可能还属于它
+        if (pos == length && !final) {
+            pos = start;
+            incomplete = true;
+            return {TOKEN_ERROR, ""};
+        }
+
+        DfaAccept accept = dfaAccept[state];
+        string_view value = slice(start);
+        if (state == S_ID) {
+            const KeywordSlot* keyword = findKeyword(value);
+            if (keyword) return {keyword->type, value, LEX_OK, keyword->kind};
+            return {TOKEN_ID, value, LEX_OK, KIND_NONE, intern(value)};
+        }
+        if (accept.type == TOKEN_OP || accept.type == TOKEN_SEP) {
+            return {accept.type, value, LEX_OK, (TokenKind)symbolKind[(unsigned char)value[0]][value.size() - 1]};
+        }
+        if (accept.type == TOKEN_NUM || accept.type == TOKEN_FLOAT) {
+            Token token = numberToken(accept.type, value);
+            if (token.type != TOKEN_ERROR) token.symbol = intern(value);
+            return token;
+        }
+        return {accept.type, value, accept.error};
+    }
+};
+
+#endif // LEXER_H
@@ -0,0 +1,111 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// 只读输入文件：普通文件直接 mmap，词法分析在映射区上进行，不再复制到 string；
+// 管道、标准输入（路径为 "-"）等无法映射的输入退化为一次缓冲读取
+class MappedFile {
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+    vector<char> buffer; // 未映射时的读取缓冲区
+
+    // 从 FILE* 一次性读入全部内容
+    bool readAll(FILE* file) {
+        buffer.clear();
+        size_t capacity = 1 << 16;
+        while (true) {
+            buffer.resize(length + capacity);
+            size_t n = fread(buffer.data() + length, 1, capacity, file);
+            length += n;
+            if (n < capacity) break;
+            capacity *= 2;
+        }
+        buffer.resize(length);
+        data = buffer.data();
+        return !ferror(file);
+    }
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        close();
+    }
+
+    // 打开并映射文件，失败返回 false
+    bool open(const string& path) {
+        close();
+        if (path == "-") {
+            return readAll(stdin);
+        }
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+            flags |= MAP_POPULATE; // 预先建立页表，避免扫描时逐页缺页
+#endif
+            void* addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, flags, fd, 0);
+            if (addr != MAP_FAILED) {
+                madvise(addr, (size_t)st.st_size, MADV_SEQUENTIAL);
+                ::close(fd);
+                data = (const char*)addr;
+                length = (size_t)st.st_size;
+                mapped = true;
+                return true;
+            }
+        }
+        // 管道、字符设备、空文件或映射失败：按普通流读取
+        FILE* file = fdopen(fd, "rb");
+        if (!file) {
+            ::close(fd);
+            return false;
+        }
+#else
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file) return false;
+#endif
+        bool ok = readAll(file);
+        fclose(file);
+        return ok;
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (mapped) munmap((void*)data, length);
+#endif
+        data = nullptr;
+        length = 0;
+        mapped = false;
+        buffer.clear();
+        buffer.shrink_to_fit();
+    }
+
+    string_view view() const {
+        return string_view(data, length);
+    }
+
+    bool isMapped() const {
+        return mapped;
+    }
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,104 @@
+#ifndef PARALLEL_LEXER_H
+#define PARALLEL_LEXER_H
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "lexer.h"
+using namespace std;
+
+// 并行词法分析的一段输入：每段都从换行符之后开始，换行符不会出现在单词符号内部，
+// 所以段首一定是单词符号的边界，只需要知道段首是否处在块注释中
+struct LexSegment {
+    string_view text;
+    CommentState startState = COMMENT_NONE;
+};
+
+// 从 state 出发扫描 [p, end)，返回结束时所处的注释状态。
+// 注释只在单词符号边界上识别，而 '/' 不会出现在任何单词符号的中间，
+// 所以这里只看 '/'、'*'、'\n' 就能得到和 Lexer 完全一致的注释状态
+inline CommentState scanCommentState(const char* p, const char* end, CommentState state) {
+    const ScanKernels& kernels = scanKernels();
+    while (p < end) {
+        if (state == COMMENT_NONE) {
+            const char* slash = (const char*)memchr(p, '/', (size_t)(end - p));
+            if (!slash || end - slash < 2) break;
+            if (slash[1] == '/') {
+                state = COMMENT_LINE;
+            } else if (slash[1] == '*') {
+                state = COMMENT_BLOCK;
+            } else {
+                p = slash + 1;
+                continue;
+            }
+            p = slash + 2;
+        } else if (state == COMMENT_LINE) {
+            const char* newline = (const char*)memchr(p, '\n', (size_t)(end - p));
+            if (!newline) break;
+            state = COMMENT_NONE;
+            p = newline + 1;
+        } else {
+            const char* close = kernels.findCommentEnd(p, end);
+            if (close == end) break;
+            state = COMMENT_NONE;
+            p = close + 2;
+        }
+    }
+    return state;
+}
+
+// 用最多 threads 个线程执行 work(0) ... work(count - 1)
+template <typename Work>
+void runParallel(size_t count, unsigned threads, Work work) {
+    threads = (unsigned)min<size_t>(max(threads, 1u), count);
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; ++i) work(i);
+        return;
+    }
+    vector<thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t]() {
+            for (size_t i = t; i < count; i += threads) work(i);
+        });
+    }
+    for (auto& th : pool) th.join();
+}
+
+// 把源程序切成大约 segmentSize 字节的若干段，并确定每段开头的注释状态。
+// 每段从 NONE 和 BLOCK 两种起始状态各扫描一遍（可以并行），再顺序串起来决定真实状态
+inline vector<LexSegment> splitSource(string_view source, size_t segmentSize, unsigned threads) {
+    vector<LexSegment> segments;
+    const char* text = source.data();
+    size_t length = source.length();
+    segmentSize = max<size_t>(segmentSize, 1);
+    size_t start = 0;
+    while (start < length) {
+        size_t cut = start + segmentSize;
+        if (cut >= length) {
+            cut = length;
+        } else {
+            const char* newline = (const char*)memchr(text + cut, '\n', length - cut);
+            cut = newline ? (size_t)(newline - text) + 1 : length;
+        }
+        segments.push_back({source.substr(start, cut - start), COMMENT_NONE});
+        start = cut;
+    }
+
+    // 段尾一定是换行符（最后一段除外），所以段首的状态只可能是 NONE 或 BLOCK
+    vector<CommentState> endFromNone(segments.size()), endFromBlock(segments.size());
+    runParallel(segments.size(), threads, [&](size_t i) {
+        const char* begin = segments[i].text.data();
+        const char* end = begin + segments[i].text.length();
+        endFromNone[i] = scanCommentState(begin, end, COMMENT_NONE);
+        endFromBlock[i] = scanCommentState(begin, end, COMMENT_BLOCK);
+    });
+    for (size_t i = 1; i < segments.size(); ++i) {
+        CommentState prev = segments[i - 1].startState == COMMENT_BLOCK ? endFromBlock[i - 1] : endFromNone[i - 1];
+        segments[i].startState = prev == COMMENT_BLOCK ? COMMENT_BLOCK : COMMENT_NONE;
+    }
+    return segments;
+}
+
+#endif // PARALLEL_LEXER_H
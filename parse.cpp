@@ -2,186 +2,171 @@
 #include <fstream>
 #include <string>
 #include <vector>
-#include <unordered_map>
-#include <stack>
+#include <array>
 #include <queue>
 #include <cctype>
 #include <algorithm>
+#include "ast.h"
+#include "interpreter.h"
+#include "vm.h"
+#include "jit.h"
+#include "c_backend.h"
+#include "ssa.h"
+#include "fold.h"
+#include "lexer.h"
+#include "mapped_file.h"
+#include "token_cursor.h"
+#include "token_file.h"
+#include "token_pipeline.h"
 using namespace std;
 
-// 单词符号类型编码（复用词法分析器的定义）
-enum TokenType
-{
-    TOKEN_ID,      // 标识符
-    TOKEN_NUM,     // 整常数
-    TOKEN_FLOAT,   // 浮点数
-    TOKEN_BOOL,    // 布尔常量
-    TOKEN_KEYWORD, // 关键字
-    TOKEN_OP,      // 运算符
-    TOKEN_SEP,     // 分隔符
-    TOKEN_ERROR    // 错误
-};
+// 表达式中的运算符：TokenKind 中的运算符，外加分析时才从减号区分出来的一元负号
+constexpr unsigned char OP_NEG = KIND_COUNT;
+constexpr size_t EXPR_OP_COUNT = KIND_COUNT + 1;
 
-// 语法树节点类型
-enum NodeType
-{
-    NODE_EXPR,    // 表达式
-    NODE_BOOL,    // 布尔表达式
-    NODE_DECLS,   // 声明语句
-    NODE_STMTS,   // 执行语句
-    NODE_ASSIGN,  // 赋值语句
-    NODE_IF,      // if语句
-    NODE_WHILE,   // while语句
-    NODE_FOR,     // for语句
-    NODE_READ,    // read语句
-    NODE_WRITE,   // write语句
-    NODE_BLOCK,   // 语句块
-    NODE_OP,      // 运算符
-    NODE_ID,      // 标识符
-    NODE_NUM,     // 数字常量
-    NODE_FLOAT,   // 浮点数常量
-    NODE_BOOLVAL, // 布尔值
-    NODE_TYPE,    // 类型
-    NODE_LIST     // 列表
+// 运算符的结合力（Pratt 分析），0 表示不能出现在该位置
+struct ExprOp {
+    unsigned char left;   // 跟在操作数后面时的左结合力（中缀或后缀）
+    unsigned char right;  // 中缀运算符右操作数的最小结合力，0 表示后缀运算符
+    unsigned char prefix; // 作为前缀运算符时操作数的最小结合力
+    const char *text;     // 语法树中的拼写
 };
 
-// 语法树节点结构
-struct TreeNode
+// 结合力表，按运算符类别下标访问。二元运算符都是左结合（right = left + 1）；
+// 优先级从低到高：= & |，||，&&，比较，+ -，* /，一元的 ! 负号 ++ --。
+// = & | 不是表达式运算符，出现在表达式中时按优先级最低的二元运算符处理
+constexpr array<ExprOp, EXPR_OP_COUNT> makeExprOps() {
+    array<ExprOp, EXPR_OP_COUNT> ops{};
+    ops[OP_ASSIGN] = {2, 3, 0, "="};
+    ops[OP_BITAND] = {2, 3, 0, "&"};
+    ops[OP_BITOR] = {2, 3, 0, "|"};
+    ops[OP_OR] = {4, 5, 0, "||"};
+    ops[OP_AND] = {6, 7, 0, "&&"};
+    ops[OP_EQ] = {8, 9, 0, "=="};
+    ops[OP_NE] = {8, 9, 0, "!="};
+    ops[OP_LT] = {8, 9, 0, "<"};
+    ops[OP_LE] = {8, 9, 0, "<="};
+    ops[OP_GT] = {8, 9, 0, ">"};
+    ops[OP_GE] = {8, 9, 0, ">="};
+    ops[OP_PLUS] = {10, 11, 0, "+"};
+    ops[OP_MINUS] = {10, 11, 0, "-"};
+    ops[OP_MUL] = {12, 13, 0, "*"};
+    ops[OP_DIV] = {12, 13, 0, "/"};
+    ops[OP_INC] = {14, 0, 15, "++"};
+    ops[OP_DEC] = {14, 0, 15, "--"};
+    ops[OP_NOT] = {0, 0, 15, "!"};
+    ops[OP_NEG] = {0, 0, 15, "neg"};
+    return ops;
+}
+
+constexpr auto exprOps = makeExprOps();
+
+// 语法分析器类，单词符号按需从 TokenSource 拉取，语法树由 Tree（FlatTree 或 PointerTree）构造
+template <typename TokenSource, typename Tree = FlatTree>
+class Parser
 {
-    NodeType type;
-    string value;
-    vector<TreeNode *> children;
+private:
+    using Node = typename Tree::Node;
 
-    TreeNode(NodeType t, const string &v = "") : type(t), value(v) {}
+    TokenCursor<TokenSource> tokens;
+    Tree &tree; // 语法树的存储，由调用方持有
 
-    ~TreeNode()
+    Node newNode(NodeType type, string_view value = "")
     {
-        for (auto child : children)
-        {
-            delete child;
-        }
+        return tree.newNode(type, value);
     }
-};
 
-// 单词符号的二元组（复用词法分析器的定义）
-struct Token
-{
-    TokenType type;
-    string value;
-};
+    // 标识符和常量节点：单词符号已经驻留时直接用它的编号，否则按拼写驻留；
+    // 常量节点同时带上词法分析时转换好的值
+    Node newNode(NodeType type, const Token &token)
+    {
+        uint32_t symbol = token.symbol ? token.symbol : tree.intern(token.value);
+        if (type == NODE_NUM || type == NODE_FLOAT)
+            return tree.newLiteralNode(type, symbol, token.literal);
+        return tree.newSymbolNode(type, symbol);
+    }
 
-// 语法分析器类
-class Parser
-{
-private:
-    vector<Token> tokens;
-    size_t current = 0;
+    void addChild(Node node, Node child)
+    {
+        tree.addChild(node, child);
+    }
 
-    TreeNode* parseDecl() {
+    Node parseDecl() {
         cerr << "DEBUG: Parsing declaration, current token: " << peek().value << endl;
         // 解析类型关键字
-        string type;
-        if (match(TOKEN_KEYWORD, "int")) {
-            type = "int";
-        } else if (match(TOKEN_KEYWORD, "float")) {
-            type = "float";
-        } else if (match(TOKEN_KEYWORD, "bool")) {
-            type = "bool";
-        } else {
+        if (!match(KW_INT) && !match(KW_FLOAT) && !match(KW_BOOL)) {
             error("Expected type keyword in declaration");
         }
         
-        TreeNode* declNode = new TreeNode(NODE_LIST);
-        declNode->children.push_back(new TreeNode(NODE_TYPE, type));
+        Node declNode = newNode(NODE_LIST);
+        addChild(declNode, newNode(NODE_TYPE, previous().value));
     
         // 解析变量声明（允许带初始化）
         do {
             // 检查标识符是否合法（不以数字开头）
             if (peek().type == TOKEN_ERROR || isdigit(peek().value[0])) {
-                error("Invalid identifier name: " + peek().value);
+                error("Invalid identifier name: " + string(peek().value));
             }
             consume(TOKEN_ID, "Expected variable name");
-            TreeNode* idNode = new TreeNode(NODE_ID, previous().value);
-            declNode->children.push_back(idNode);
+            Node idNode = newNode(NODE_ID, previous());
+            addChild(declNode, idNode);
     
             // 处理初始化
-            if (match(TOKEN_OP, "=")) {
-                TreeNode* initNode = (type == "bool") ? parseBoolExpr() : parseArithmeticExpr();
-                declNode->children.push_back(initNode);
+            if (match(OP_ASSIGN)) {
+                addChild(declNode, parseExpression());
             }
-        } while (match(TOKEN_SEP, ",")); // 支持多变量声明，如 int a,b=2;
+        } while (match(SEP_COMMA)); // 支持多变量声明，如 int a,b=2;
     
-        consume(TOKEN_SEP, ";", "Expected ';' after declaration");
+        consume(SEP_SEMI, "Expected ';' after declaration");
         return declNode;
     }
 
-    TreeNode* parseStmts() {
-        TreeNode* stmtsNode = new TreeNode(NODE_STMTS);
-        while (!isAtEnd() && !check(TOKEN_SEP, "}")) {
-            TreeNode* stmt = parseStmt();
-            if (stmt) {
-                stmtsNode->children.push_back(stmt);
+    Node parseStmts() {
+        Node stmtsNode = newNode(NODE_STMTS);
+        while (!isAtEnd() && !check(SEP_RBRACE)) {
+            Node stmt = parseStmt();
+            if (stmt != Tree::NONE) {
+                addChild(stmtsNode, stmt);
             }
         }
         return stmtsNode;
     }
 
     // 查看当前token
-    Token peek() const
+    const Token &peek() const
     {
-        if (current < tokens.size())
-        {
-            return tokens[current];
-        }
-        return {TOKEN_ERROR, ""};
+        return tokens.peek();
     }
 
     // 查看前一个token
-    Token previous() const
+    const Token &previous() const
     {
-        if (current > 0)
-        {
-            return tokens[current - 1];
-        }
-        return {TOKEN_ERROR, ""};
+        return tokens.previous();
     }
 
     // 检查是否到达末尾
     bool isAtEnd() const
     {
-        return peek().type == TOKEN_ERROR && peek().value.empty();
+        return tokens.atEnd();
     }
 
     // 前进到下一个token
-    Token advance()
+    const Token &advance()
     {
-        if (!isAtEnd())
-            current++;
+        tokens.advance();
         return previous();
     }
 
     // 检查当前token是否匹配给定类型
     bool check(TokenType type) const
     {
-        if (isAtEnd())
-            return false;
-        return peek().type == type;
+        return !isAtEnd() && peek().type == type;
     }
 
-    // 检查当前token是否匹配给定类型和值
-    bool check(TokenType type, const string &value) const
+    // 检查当前token是否为给定的关键字、运算符或分隔符
+    bool check(TokenKind kind) const
     {
-        if (isAtEnd())
-            return false;
-        return peek().type == type && peek().value == value;
-    }
-
-    // 检查当前token是否匹配给定值（类型不限）
-    bool check(const string &value) const
-    {
-        if (isAtEnd())
-            return false;
-        return peek().value == value;
+        return peek().kind == kind;
     }
 
     // 匹配给定类型
@@ -195,21 +180,10 @@ private:
         return false;
     }
 
-    // 匹配给定类型和值
-    bool match(TokenType type, const string &value)
+    // 匹配给定的关键字、运算符或分隔符
+    bool match(TokenKind kind)
     {
-        if (check(type, value))
-        {
-            advance();
-            return true;
-        }
-        return false;
-    }
-
-    // 匹配给定值（类型不限）
-    bool match(const string &value)
-    {
-        if (check(value))
+        if (check(kind))
         {
             advance();
             return true;
@@ -220,7 +194,7 @@ private:
     // 错误处理
     void error(const string &message)
     {
-        cerr << "Syntax error: " << message << " at token: " << peek().value << endl;
+        cerr << "Syntax error: " << message << " at token: " << lexErrorText(peek().error) << peek().value << endl;
         exit(1);
     }
 
@@ -235,198 +209,122 @@ private:
         error(message);
     }
 
-    // 消耗一个token（指定值和类型），如果不匹配则报错
-    void consume(TokenType type, const string &value, const string &message)
-    {
-        if (check(type, value))
-        {
-            advance();
-            return;
-        }
-        error(message + " (Actual: " + peek().value + ")");
-    }
-
-    // 消耗一个token（指定值），如果不匹配则报错
-    void consume(const string &value, const string &message)
+    // 消耗一个token（指定关键字、运算符或分隔符），如果不匹配则报错
+    void consume(TokenKind kind, const string &message)
     {
-        if (check(value))
+        if (check(kind))
         {
             advance();
             return;
         }
-        error(message);
+        error(message + " (Actual: " + string(peek().value) + ")");
     }
 
-    TreeNode *parseArithmeticExpr() {
+    // 表达式入口，结果包在 EXPR 节点中
+    Node parseExpression() {
         // 添加空表达式检查
-        if (check(TOKEN_SEP, ";")) {
+        if (check(SEP_SEMI)) {
             error("Empty expression not allowed here");
         }
-        
-        // 使用算符优先分析法处理算术表达式
-        stack<TreeNode *> nodeStack;
-        stack<string> opStack;
-    
-        // 算符优先级表
-        unordered_map<string, int> precedence = {
-            {"||", 1}, {"&&", 2},
-            {"==", 3}, {"!=", 3}, {"<", 3}, {"<=", 3}, {">", 3}, {">=", 3},
-            {"+", 4}, {"-", 4},
-            {"*", 5}, {"/", 5}, {"%", 5},
-            {"!", 6}, {"++", 6}, {"--", 6}};
-    
-        auto processOp = [&]() {
-            string op = opStack.top();
-            opStack.pop();
-    
-            TreeNode *node = new TreeNode(NODE_OP, op);
-    
-            // 处理一元运算符
-            if (op == "!" || op == "++" || op == "--") {
-                if (nodeStack.empty())
-                    error("Missing operand for unary operator");
-                node->children.push_back(nodeStack.top());
-                nodeStack.pop();
-            }
-            // 处理二元运算符
-            else {
-                if (nodeStack.size() < 2)
-                    error("Missing operands for binary operator");
-                TreeNode *right = nodeStack.top();
-                nodeStack.pop();
-                TreeNode *left = nodeStack.top();
-                nodeStack.pop();
-    
-                node->children.push_back(left);
-                node->children.push_back(right);
-            }
-    
-            nodeStack.push(node);
-        };
-    
-        while (!isAtEnd() && !check(TOKEN_SEP, ";") && !check(TOKEN_SEP, ",") &&
-            !check(TOKEN_KEYWORD, "then") && !check(TOKEN_KEYWORD, "do") &&
-            !check(TOKEN_KEYWORD, "else") && !check(TOKEN_SEP, "{")) {  // 添加对{的检查
-            if (match(TOKEN_SEP, "(")) {
-                opStack.push("(");
-            } else if (match(TOKEN_SEP, ")")) {
-                while (!opStack.empty() && opStack.top() != "(") {
-                    processOp();
-                }
-                if (opStack.empty()) {
-                    error("Unmatched parentheses");
-                }
-                opStack.pop(); // 弹出 "("
-            } else if (match(TOKEN_OP)) {
-                string op = previous().value;
-    
-                // 处理负号（减号和负号的歧义）
-                if (op == "-" && (nodeStack.empty() ||
-                                (!opStack.empty() && opStack.top() == "("))) {
-                    op = "neg"; // 标记为一元负号
-                }
-    
-                while (!opStack.empty() && opStack.top() != "(" &&
-                    precedence[opStack.top()] >= precedence[op]) {
-                    processOp();
-                }
-                opStack.push(op);
-            } else {
-                // 处理操作数
-                TreeNode *operand = nullptr;
-                if (match(TOKEN_ID)) {
-                    operand = new TreeNode(NODE_ID, previous().value);
-                } else if (match(TOKEN_NUM)) {
-                    operand = new TreeNode(NODE_NUM, previous().value);
-                } else if (match(TOKEN_FLOAT)) {
-                    operand = new TreeNode(NODE_FLOAT, previous().value);
-                } else if (match(TOKEN_BOOL)) {
-                    operand = new TreeNode(NODE_BOOLVAL, previous().value);
-                } else {
-                    error("Expected operand in expression");
-                }
-                nodeStack.push(operand);
+
+        Node exprNode = newNode(NODE_EXPR);
+        addChild(exprNode, parseExpr(0));
+        return exprNode;
+    }
+
+    // Pratt 分析：读一个操作数（可带前缀运算符），再把左结合力不小于 minPower 的
+    // 中缀和后缀运算符依次结合上去。比较运算符也在结合力表中，算术表达式和布尔表达式
+    // 一次分析完；遇到不是运算符的单词符号（如 ) ; , {）表达式即结束
+    Node parseExpr(unsigned char minPower) {
+        Node left = parsePrefix();
+        while (true) {
+            const Token &token = peek();
+            if (token.type != TOKEN_OP)
+                break;
+            const ExprOp &op = exprOps[token.kind];
+            if (op.left == 0 || op.left < minPower)
+                break;
+            advance();
+
+            Node node = newNode(NODE_OP, op.text);
+            addChild(node, left);
+            if (op.right != 0) {
+                addChild(node, parseExpr(op.right));
             }
+            left = node;
         }
-    
-        // 处理剩余的运算符
-        while (!opStack.empty()) {
-            if (opStack.top() == "(") {
+        return left;
+    }
+
+    // 操作数、括号表达式或前缀运算符
+    Node parsePrefix() {
+        if (match(SEP_LPAREN)) {
+            Node inner = parseExpr(0);
+            if (!match(SEP_RPAREN)) {
                 error("Unmatched parentheses");
             }
-            processOp();
-        }
-    
-        if (nodeStack.empty()) {
-            error("Empty expression");
-        }
-        if (nodeStack.size() > 1) {
-            error("Malformed expression");
+            return inner;
+        }
+        if (check(TOKEN_OP)) {
+            // 处理负号（减号和负号的歧义）：操作数位置上的 - 是一元负号
+            unsigned char kind = peek().kind == OP_MINUS ? (unsigned char)OP_NEG : (unsigned char)peek().kind;
+            const ExprOp &op = exprOps[kind];
+            if (op.prefix == 0) {
+                error("Missing operand for operator");
+            }
+            advance();
+            Node node = newNode(NODE_OP, op.text);
+            addChild(node, parseExpr(op.prefix));
+            return node;
+        }
+
+        // 处理操作数
+        NodeType type;
+        switch (peek().type) {
+        case TOKEN_ID:
+            type = NODE_ID;
+            break;
+        case TOKEN_NUM:
+            type = NODE_NUM;
+            break;
+        case TOKEN_FLOAT:
+            type = NODE_FLOAT;
+            break;
+        case TOKEN_BOOL:
+            type = NODE_BOOLVAL;
+            break;
+        default:
+            error("Expected operand in expression");
+            return Tree::NONE;
         }
-    
-        TreeNode *exprNode = new TreeNode(NODE_EXPR);
-        exprNode->children.push_back(nodeStack.top());
-        return exprNode;
+        return newNode(type, advance());
     }
 
-    // 布尔表达式（复用算术表达式的算符优先分析）
-    TreeNode *parseBoolExpr() {
-        TreeNode *left = parseArithmeticExpr();
-        
-        if (check(TOKEN_SEP, "{")) {
-            return left;
-        }
-
-        // 处理比较运算符
-        if (check(TOKEN_OP, ">") || check(TOKEN_OP, "<") || 
-            check(TOKEN_OP, ">=") || check(TOKEN_OP, "<=") ||
-            check(TOKEN_OP, "==") || check(TOKEN_OP, "!=")) {
-            Token op = advance();
-            TreeNode *right = parseArithmeticExpr();
-            
-            TreeNode *boolNode = new TreeNode(NODE_BOOL, op.value);
-            boolNode->children.push_back(left);
-            boolNode->children.push_back(right);
-            return boolNode;
-        }
-        
-        // 如果没有比较运算符，直接返回算术表达式
-        return left;
-    }
-    
     // 声明语句
-    TreeNode *parseDecls()
+    Node parseDecls()
     {
-        TreeNode* declsNode = new TreeNode(NODE_DECLS);
+        Node declsNode = newNode(NODE_DECLS);
         while (!isAtEnd()) {
-            if (check(TOKEN_KEYWORD, "int") || check(TOKEN_KEYWORD, "float") || check(TOKEN_KEYWORD, "bool")) {
-                string type;
-                if (match(TOKEN_KEYWORD, "int")) {
-                    type = "int";
-                } else if (match(TOKEN_KEYWORD, "float")) {
-                    type = "float";
-                } else if (match(TOKEN_KEYWORD, "bool")) {
-                    type = "bool";
-                } // 闭合if语句块
+            if (check(KW_INT) || check(KW_FLOAT) || check(KW_BOOL)) {
+                advance();
     
-                TreeNode* typeNode = new TreeNode(NODE_TYPE, type);
-                TreeNode* declNode = new TreeNode(NODE_LIST);
-                declNode->children.push_back(typeNode);
+                Node typeNode = newNode(NODE_TYPE, previous().value);
+                Node declNode = newNode(NODE_LIST);
+                addChild(declNode, typeNode);
     
                 do {
-                    if (match(TOKEN_SEP, ";")) break; // 允许空声明
+                    if (match(SEP_SEMI)) break; // 允许空声明
                     consume(TOKEN_ID, "Expected variable name in declaration");
-                    TreeNode* idNode = new TreeNode(NODE_ID, previous().value);
-                    declNode->children.push_back(idNode);
+                    Node idNode = newNode(NODE_ID, previous());
+                    addChild(declNode, idNode);
     
-                    if (match(TOKEN_OP, "=")) {
-                        TreeNode* initNode = (type == "bool") ? parseBoolExpr() : parseArithmeticExpr();
-                        declNode->children.push_back(initNode);
+                    if (match(OP_ASSIGN)) {
+                        addChild(declNode, parseExpression());
                     }
-                } while (match(TOKEN_SEP, ","));
+                } while (match(SEP_COMMA));
     
-                consume(TOKEN_SEP, ";", "Expected ';' after declaration");
-                declsNode->children.push_back(declNode);
+                consume(SEP_SEMI, "Expected ';' after declaration");
+                addChild(declsNode, declNode);
             } else {
                 break; // 无更多声明
             }
@@ -435,344 +333,249 @@ private:
     }
 
     // 赋值语句
-    TreeNode *parseAssignStmt(bool inForLoop = false) {
+    Node parseAssignStmt(bool inForLoop = false) {
         consume(TOKEN_ID, "Expected identifier in assignment");
-        TreeNode *idNode = new TreeNode(NODE_ID, previous().value);
+        Node idNode = newNode(NODE_ID, previous());
 
-        string op = peek().value;
+        Token op = peek();
         
         // 处理自增/自减运算符
-        if (op == "++" || op == "--") {
+        if (op.kind == OP_INC || op.kind == OP_DEC) {
             consume(TOKEN_OP, "Expected operator");
-            TreeNode *assignNode = new TreeNode(NODE_ASSIGN, op);
-            assignNode->children.push_back(idNode);
+            Node assignNode = newNode(NODE_ASSIGN, op.value);
+            addChild(assignNode, idNode);
             if (!inForLoop) {
-                consume(TOKEN_SEP, ";", "Expected ';' after assignment");
+                consume(SEP_SEMI, "Expected ';' after assignment");
             }
             return assignNode;
         }
         
         consume(TOKEN_OP, "Expected assignment operator");
-        TreeNode *assignNode = new TreeNode(NODE_ASSIGN, op);
-        assignNode->children.push_back(idNode);
-
-        if (op == "=") {
-            // 需要判断是算术表达式还是布尔表达式
-            if (check(TOKEN_BOOL) || check(TOKEN_OP, "!") ||
-                check(TOKEN_ID) || check(TOKEN_SEP, "(")) {
-                assignNode->children.push_back(parseBoolExpr());
-            } else {
-                assignNode->children.push_back(parseArithmeticExpr());
-            }
-        } else {
-            // 复合赋值运算符如 +=, -= 等
-            assignNode->children.push_back(parseArithmeticExpr());
-        }
+        Node assignNode = newNode(NODE_ASSIGN, op.value);
+        addChild(assignNode, idNode);
+
+        // 算术表达式和布尔表达式由同一个表达式分析器处理
+        addChild(assignNode, parseExpression());
 
         if (!inForLoop) {
-            consume(TOKEN_SEP, ";", "Expected ';' after assignment");
+            consume(SEP_SEMI, "Expected ';' after assignment");
         }
         return assignNode;
     }
 
     // if语句
-    TreeNode* parseIfStmt() {
+    Node parseIfStmt() {
         cerr << "DEBUG: Enter parseIfStmt, current token: " << peek().value << endl;
-        consume(TOKEN_KEYWORD, "if", "Expected 'if'");
-        consume(TOKEN_SEP, "(", "Expected '(' after 'if'");
+        consume(KW_IF, "Expected 'if'");
+        consume(SEP_LPAREN, "Expected '(' after 'if'");
         
         // 解析条件表达式
-        TreeNode* cond = parseBoolExpr();
-        cerr << "DEBUG: After parseBoolExpr, current token: " << peek().value << endl;
-        consume(TOKEN_SEP, ")", "Expected ')' after condition");
+        Node cond = parseExpression();
+        cerr << "DEBUG: After parseExpression, current token: " << peek().value << endl;
+        consume(SEP_RPAREN, "Expected ')' after condition");
 
-        // 确保消耗{
-        consume(TOKEN_SEP, "{", "Expected '{' to start if block");
-        
-        // 解析then分支
-        TreeNode* thenBranch = nullptr;
-        if (match(TOKEN_SEP, "{")) {
-            thenBranch = parseBlock();
-        } else {
-            // 单条语句的情况
-            thenBranch = parseStmt();
-            // 如果stmt以分号结束，需要消耗分号
-            if (check(TOKEN_SEP, ";")) {
-                advance();
-            }
-        }
+        // 解析then分支（语句块或单条语句，与while一致）
+        Node thenBranch = check(SEP_LBRACE) ? parseBlock() : parseStmt();
         
-        TreeNode* ifNode = new TreeNode(NODE_IF);
-        ifNode->children.push_back(cond);
-        ifNode->children.push_back(thenBranch);
+        Node ifNode = newNode(NODE_IF);
+        addChild(ifNode, cond);
+        addChild(ifNode, thenBranch);
         
         // 解析else分支
-        if (match(TOKEN_KEYWORD, "else")) {
-            // 确保消耗{
-            consume(TOKEN_SEP, "{", "Expected '{' to start else block");
-            TreeNode* elseBranch = parseBlock();
-            ifNode->children.push_back(elseBranch);
+        if (match(KW_ELSE)) {
+            Node elseBranch = check(SEP_LBRACE) ? parseBlock() : parseStmt();
+            addChild(ifNode, elseBranch);
         }
         return ifNode;
     }
 
     // while语句
-    TreeNode* parseWhileStmt() 
+    Node parseWhileStmt() 
 {
-    consume(TOKEN_KEYWORD, "while", "Expected 'while'");
-    consume(TOKEN_SEP, "(", "Expected '(' after 'while'");
+    consume(KW_WHILE, "Expected 'while'");
+    consume(SEP_LPAREN, "Expected '(' after 'while'");
     
-    TreeNode* whileNode = new TreeNode(NODE_WHILE);
-    whileNode->children.push_back(parseBoolExpr());
+    Node whileNode = newNode(NODE_WHILE);
+    addChild(whileNode, parseExpression());
     
     // 确保消耗右括号
-    consume(TOKEN_SEP, ")", "Expected ')' after condition");
+    consume(SEP_RPAREN, "Expected ')' after condition");
     
     // 直接解析循环体（可以是语句块或单条语句）
-    if (check(TOKEN_SEP, "{")) {
-        whileNode->children.push_back(parseBlock());
+    if (check(SEP_LBRACE)) {
+        addChild(whileNode, parseBlock());
     } else {
-        whileNode->children.push_back(parseStmt());
+        addChild(whileNode, parseStmt());
     }
     
     return whileNode;
 }
 
     // for语句
-    TreeNode* parseForStmt() {
+    Node parseForStmt() {
         cerr << "DEBUG: Parsing for statement, current token: " << peek().value << endl;
-        consume(TOKEN_KEYWORD, "for", "Expected 'for'");
-        consume(TOKEN_SEP, "(", "Expected '(' after 'for'");
+        consume(KW_FOR, "Expected 'for'");
+        consume(SEP_LPAREN, "Expected '(' after 'for'");
         
-        TreeNode* forNode = new TreeNode(NODE_FOR);
+        Node forNode = newNode(NODE_FOR);
         
         // 初始化部分
-        if (!check(TOKEN_SEP, ";")) {
+        if (!check(SEP_SEMI)) {
             cerr << "DEBUG: Parsing for initializer" << endl;
-            if (check(TOKEN_KEYWORD, "int") || check(TOKEN_KEYWORD, "float") || check(TOKEN_KEYWORD, "bool")) {
+            if (check(KW_INT) || check(KW_FLOAT) || check(KW_BOOL)) {
                 cerr << "DEBUG: Found type declaration in for initializer" << endl;
                 // 使用parseDecl()来处理类型声明，parseDecl()已经消耗了分号
-                TreeNode* decl = parseDecl();
-                forNode->children.push_back(decl);
+                Node decl = parseDecl();
+                addChild(forNode, decl);
             } else {
-                TreeNode* assign = parseAssignStmt();
-                forNode->children.push_back(assign);
+                Node assign = parseAssignStmt(true);
+                addChild(forNode, assign);
                 // 只有非类型声明的情况才需要消耗分号
-                consume(TOKEN_SEP, ";", "Expected ';' after for initializer");
+                consume(SEP_SEMI, "Expected ';' after for initializer");
             }
         } else {
-            forNode->children.push_back(nullptr);
-            consume(TOKEN_SEP, ";", "Expected ';' after for initializer");
+            addChild(forNode, Tree::NONE);
+            consume(SEP_SEMI, "Expected ';' after for initializer");
         }
         
         // 条件部分
         cerr << "DEBUG: Before condition, current token: " << peek().value << endl;
-        if (!check(TOKEN_SEP, ";")) {
-            forNode->children.push_back(parseBoolExpr());
+        if (!check(SEP_SEMI)) {
+            addChild(forNode, parseExpression());
         } else {
-            forNode->children.push_back(nullptr);
+            addChild(forNode, Tree::NONE);
         }
-        consume(TOKEN_SEP, ";", "Expected ';' after for condition");
+        consume(SEP_SEMI, "Expected ';' after for condition");
         cerr << "DEBUG: After condition, current token: " << peek().value << endl;
         
         // 迭代表达式
-        if (!check(TOKEN_SEP, ")")) {
-            TreeNode* updateNode = parseAssignStmt(true); // 传递true表示在for循环中
-            forNode->children.push_back(updateNode);
+        if (!check(SEP_RPAREN)) {
+            Node updateNode = parseAssignStmt(true); // 传递true表示在for循环中
+            addChild(forNode, updateNode);
         } else {
-            forNode->children.push_back(nullptr);
+            addChild(forNode, Tree::NONE);
         }
-        consume(TOKEN_SEP, ")", "Expected ')' after for update");
+        consume(SEP_RPAREN, "Expected ')' after for update");
         
         // 循环体 - 允许语句块或单条语句
-        if (check(TOKEN_SEP, "{")) {
-            forNode->children.push_back(parseBlock());
+        if (check(SEP_LBRACE)) {
+            addChild(forNode, parseBlock());
         } else {
             // 单条语句的情况
-            TreeNode* stmtNode = new TreeNode(NODE_BLOCK);
-            stmtNode->children.push_back(parseStmt());
-            forNode->children.push_back(stmtNode);
+            Node stmtNode = newNode(NODE_BLOCK);
+            addChild(stmtNode, parseStmt());
+            addChild(forNode, stmtNode);
         }
         
         return forNode;
     }
 
     // read语句
-    TreeNode *parseReadStmt()
+    Node parseReadStmt()
     {
-        consume(TOKEN_KEYWORD, "read", "Expected 'read'");
-        consume(TOKEN_SEP, "(", "Expected '(' after 'read'");
+        consume(KW_READ, "Expected 'read'");
+        consume(SEP_LPAREN, "Expected '(' after 'read'");
 
-        TreeNode *readNode = new TreeNode(NODE_READ);
+        Node readNode = newNode(NODE_READ);
 
         do
         {
             consume(TOKEN_ID, "Expected variable name in read statement");
-            readNode->children.push_back(new TreeNode(NODE_ID, previous().value));
-        } while (match(TOKEN_SEP, ","));
+            addChild(readNode, newNode(NODE_ID, previous()));
+        } while (match(SEP_COMMA));
 
-        consume(TOKEN_SEP, ")", "Expected ')' after read arguments");
-        consume(TOKEN_SEP, ";", "Expected ';' after read statement");
+        consume(SEP_RPAREN, "Expected ')' after read arguments");
+        consume(SEP_SEMI, "Expected ';' after read statement");
         return readNode;
     }
 
     // write语句
-    TreeNode *parseWriteStmt() {
-        consume(TOKEN_KEYWORD, "write", "Expected 'write'");
+    Node parseWriteStmt() {
+        consume(KW_WRITE, "Expected 'write'");
         
-        TreeNode *writeNode = new TreeNode(NODE_WRITE);
+        Node writeNode = newNode(NODE_WRITE);
         
         // 处理带括号的write语句
-        if (match(TOKEN_SEP, "(")) {
+        if (match(SEP_LPAREN)) {
             do {
                 consume(TOKEN_ID, "Expected variable name in write statement");
-                writeNode->children.push_back(new TreeNode(NODE_ID, previous().value));
-            } while (match(TOKEN_SEP, ","));
-            consume(TOKEN_SEP, ")", "Expected ')' after write arguments");
+                addChild(writeNode, newNode(NODE_ID, previous()));
+            } while (match(SEP_COMMA));
+            consume(SEP_RPAREN, "Expected ')' after write arguments");
         } else {
             // 直接读取标识符，不需要括号
             consume(TOKEN_ID, "Expected variable name in write statement");
-            writeNode->children.push_back(new TreeNode(NODE_ID, previous().value));
+            addChild(writeNode, newNode(NODE_ID, previous()));
         }
         
-        consume(TOKEN_SEP, ";", "Expected ';' after write statement");
+        consume(SEP_SEMI, "Expected ';' after write statement");
         return writeNode;
     }
 
     // 语句序列
-    TreeNode* parseStmt() {
-        if (check(TOKEN_SEP, "{")) {
+    Node parseStmt() {
+        switch (peek().kind) {
+        case SEP_LBRACE:
             return parseBlock();
-        } else if (check(TOKEN_KEYWORD, "if")) {
+        case KW_IF:
             return parseIfStmt();
-        } else if (check(TOKEN_KEYWORD, "while")) {
+        case KW_WHILE:
             return parseWhileStmt();
-        } else if (check(TOKEN_KEYWORD, "for")) {
+        case KW_FOR:
             return parseForStmt();
-        } else if (check(TOKEN_KEYWORD, "read")) {
+        case KW_READ:
             return parseReadStmt();
-        } else if (check(TOKEN_KEYWORD, "write")) {
+        case KW_WRITE:
             return parseWriteStmt();
-        } else if (check(TOKEN_ID)) {
-            return parseAssignStmt();
-        } else if (match(TOKEN_SEP, ";")) {
-            // 修改这里，直接返回空语句节点而不调用parseArithmeticExpr()
-            return new TreeNode(NODE_STMTS, "empty_stmt"); 
-        } else {
-            error("Expected statement but found: " + peek().value);
-            return nullptr;
+        case SEP_SEMI:
+            // 修改这里，直接返回空语句节点而不调用parseExpression()
+            advance();
+            return newNode(NODE_STMTS, "empty_stmt"); 
+        default:
+            if (check(TOKEN_ID)) {
+                return parseAssignStmt();
+            }
+            error("Expected statement but found: " + string(peek().value));
+            return Tree::NONE;
         }
     }
 
-    TreeNode *parseBlock() {
+    Node parseBlock() {
         // 这里确保消耗{
-        consume(TOKEN_SEP, "{", "Expected '{' to start block");
-        TreeNode* blockNode = new TreeNode(NODE_BLOCK);
+        consume(SEP_LBRACE, "Expected '{' to start block");
+        Node blockNode = newNode(NODE_BLOCK);
         
-        while (!isAtEnd() && !check(TOKEN_SEP, "}")) {
-            TreeNode* stmt = parseStmt();
-            if (stmt) {
-                blockNode->children.push_back(stmt);
+        while (!isAtEnd() && !check(SEP_RBRACE)) {
+            Node stmt = parseStmt();
+            if (stmt != Tree::NONE) {
+                addChild(blockNode, stmt);
             }
         }
         
-        consume(TOKEN_SEP, "}", "Expected '}' to end block");
+        consume(SEP_RBRACE, "Expected '}' to end block");
         return blockNode;
     }
 
 
-    // 打印语法树（辅助函数）
-    void printTree(const TreeNode *node, ofstream &outFile, int depth = 0)
-    {
-        if (!node)
-            return;
-
-        // 缩进
-        for (int i = 0; i < depth; ++i)
-        {
-            outFile << "  ";
-        }
-
-        // 打印节点类型和值
-        outFile << "[" << nodeTypeToString(node->type) << "]";
-        if (!node->value.empty())
-        {
-            outFile << " " << node->value;
-        }
-        outFile << endl;
-
-        // 打印子节点
-        for (const auto &child : node->children)
-        {
-            printTree(child, outFile, depth + 1);
-        }
-    }
-
-    // 节点类型转字符串（辅助函数）
-    string nodeTypeToString(NodeType type) const
-    {
-        switch (type)
-        {
-        case NODE_EXPR:
-            return "EXPR";
-        case NODE_BOOL:
-            return "BOOL";
-        case NODE_DECLS:
-            return "DECLS";
-        case NODE_STMTS:
-            return "STMTS";
-        case NODE_ASSIGN:
-            return "ASSIGN";
-        case NODE_IF:
-            return "IF";
-        case NODE_WHILE:
-            return "WHILE";
-        case NODE_FOR:
-            return "FOR";
-        case NODE_READ:
-            return "READ";
-        case NODE_WRITE:
-            return "WRITE";
-        case NODE_BLOCK:
-            return "BLOCK";
-        case NODE_OP:
-            return "OP";
-        case NODE_ID:
-            return "ID";
-        case NODE_NUM:
-            return "NUM";
-        case NODE_FLOAT:
-            return "FLOAT";
-        case NODE_BOOLVAL:
-            return "BOOLVAL";
-        case NODE_TYPE:
-            return "TYPE";
-        case NODE_LIST:
-            return "LIST";
-        default:
-            return "UNKNOWN";
-        }
-    }
-
 public:
-    Parser(const vector<Token> &t) : tokens(t) {}
+    Parser(TokenSource &source, Tree &t) : tokens(source), tree(t) {}
 
     // 解析入口
-    TreeNode *parse()
+    Node parse()
     {
-        TreeNode *programNode = new TreeNode(NODE_BLOCK); // 用BLOCK作为程序根节点
+        Node programNode = newNode(NODE_BLOCK); // 用BLOCK作为程序根节点
 
         // 先解析声明部分
-        programNode->children.push_back(parseDecls());
+        addChild(programNode, parseDecls());
 
         // 然后解析语句部分
-        programNode->children.push_back(parseStmts());
+        addChild(programNode, parseStmts());
 
         return programNode;
     }
 
     // 输出语法树到文件
-    void outputTree(const TreeNode *root, const string &filename)
+    void outputTree(const Node root, const string &filename)
     {
         ofstream outFile(filename);
         if (!outFile)
@@ -781,21 +584,20 @@ public:
             return;
         }
 
-        printTree(root, outFile);
+        printTree(tree, root, outFile);
         outFile.close();
         cout << "Parse success. Output written to " << filename << endl;
     }
 };
 
-// 从文件读取token序列
-vector<Token> readTokens(const string &filename) {
+// 从文本格式的单词符号文件读取token序列（调试用），值存入 block 的字符串池
+void readTokens(const string &filename, TokenBlock &block) {
     ifstream inFile(filename);
     if (!inFile) {
         cerr << "Can't open input file: " << filename << endl;
         exit(1);
     }
 
-    vector<Token> tokens;
     string line;
 
     while (getline(inFile, line)) {
@@ -814,53 +616,241 @@ vector<Token> readTokens(const string &filename) {
         string value = line.substr(typeEnd + 1, end - typeEnd - 1);
         value.erase(remove_if(value.begin(), value.end(), ::isspace), value.end());
 
-        TokenType type;
-        if (typeStr == "0")
-            type = TOKEN_ID;
-        else if (typeStr == "1")
-            type = TOKEN_NUM;
-        else if (typeStr == "2")
-            type = TOKEN_FLOAT;
-        else if (typeStr == "3")
-            type = TOKEN_BOOL;
-        else if (typeStr == "4")
-            type = TOKEN_KEYWORD;
-        else if (typeStr == "5")
-            type = TOKEN_OP;
-        else if (typeStr == "6")
-            type = TOKEN_SEP;
-        else if (typeStr == "7")  // 处理非法格式的token
-            type = TOKEN_ERROR;
-        else
-            type = TOKEN_ERROR;
+        TokenType type = TOKEN_ERROR; // 处理非法格式的token
+        if (typeStr.size() == 1 && typeStr[0] >= '0' && typeStr[0] <= '0' + TOKEN_ERROR)
+            type = (TokenType)(typeStr[0] - '0');
 
-        tokens.push_back({type, value});
+        if (type == TOKEN_NUM || type == TOKEN_FLOAT)
+            block.add(numberToken(type, value));
+        else
+            block.add({type, value, LEX_OK, tokenKind(type, value)});
     }
 
     inFile.close();
-    return tokens;
 }
 
-// 主函数
-int main()
-{
-    // 读取token序列
-    vector<Token> tokens = readTokens("lex_out.txt");
+// 语法分析之后做什么
+enum ParseAction {
+    ACTION_TREE,         // 输出语法树到 parse_out.txt
+    ACTION_RUN,          // 用树遍历解释器执行
+    ACTION_VM,           // 编译成寄存器字节码，由虚拟机执行
+    ACTION_JIT,          // 编译成字节码后再生成 x86-64 机器码执行，不支持时退回虚拟机
+    ACTION_DUMP_BYTECODE,// 输出字节码的反汇编
+    ACTION_EMIT_C,       // 输出等价的 C 程序
+    ACTION_DUMP_SSA,     // 输出 SSA 中间表示（先经过校验）
+    ACTION_COMPILE       // 生成 C 程序 parse_out.c，再用本机的 C 编译器编译成 parse_out
+};
 
-    for (const auto &token : tokens)
-    {
-        cout << "Token: type=" << token.type << ", value=" << token.value << endl;
+// 命令行选项（单词符号来源之外的部分）
+struct ParseOptions {
+    bool pointerTree = false; // 用指针树代替扁平语法树
+    bool fold = false;        // 执行或输出之前先做常量折叠
+    ParseAction action = ACTION_TREE;
+};
+
+// 解析名字和类型后执行程序，read / write 使用标准输入输出
+template <typename Tree>
+void runProgram(const Tree &tree, typename Tree::Node root, const ParseOptions &options)
+{
+    ParseAction action = options.action;
+    Program program;
+    string message;
+    if (!resolveProgram(tree, root, program, message)) {
+        cerr << "Semantic error: " << message << endl;
+        exit(1);
+    }
+    if (options.fold) {
+        FoldStats stats;
+        foldProgram(program, stats);
+        printFoldStats(stats, cerr);
+    }
+    if (action == ACTION_DUMP_SSA) {
+        SsaFunction ssa;
+        buildSsa(program, ssa);
+        if (!verifySsa(ssa, message)) {
+            cerr << "Invalid SSA: " << message << endl;
+            exit(1);
+        }
+        dumpSsa(ssa, cout);
+        return;
+    }
+    if (action == ACTION_EMIT_C) {
+        emitC(program, cout);
+        return;
+    }
+    if (action == ACTION_COMPILE) {
+        ofstream source("parse_out.c");
+        emitC(program, source);
+        source.close();
+        if (!source || !compileC("parse_out.c", "parse_out", message)) {
+            cerr << "Can't compile: " << (source ? message : "can't write parse_out.c") << endl;
+            exit(1);
+        }
+        return;
+    }
+    BufferedInput input(stdin);
+    BufferedOutput output(stdout);
+    bool ok;
+    if (action == ACTION_RUN) {
+        Interpreter interpreter(program, input, output);
+        ok = interpreter.run(message);
+    } else {
+        Bytecode bytecode;
+        compileBytecode(program, bytecode);
+        if (action == ACTION_DUMP_BYTECODE) {
+            dumpBytecode(bytecode, cout);
+            return;
+        }
+        JitRunner jit(bytecode, input, output);
+        string reason;
+        if (action == ACTION_JIT && jit.compile(reason)) {
+            ok = jit.run(message);
+        } else {
+            if (action == ACTION_JIT) cerr << "JIT unavailable (" << reason << "), using the bytecode VM" << endl;
+            VirtualMachine vm(bytecode, input, output);
+            ok = vm.run(message);
+        }
     }
+    if (!ok) {
+        cerr << "Runtime error: " << message << endl;
+        exit(1);
+    }
+}
 
-    // 语法分析
-    Parser parser(tokens);
-    TreeNode *syntaxTree = parser.parse();
+// 语法分析后输出语法树或执行程序，afterParse 在分析结束后、输出之前调用
+template <typename Tree, typename TokenSource, typename AfterParse>
+void parseInto(TokenSource &source, StringInterner &symbols, const ParseOptions &options, AfterParse afterParse)
+{
+    Tree tree(symbols); // 本次分析的语法树，函数返回时整体释放
+    Parser<TokenSource, Tree> parser(source, tree);
+    typename Tree::Node syntaxTree = parser.parse();
+    afterParse();
+
+    if (options.action != ACTION_TREE) {
+        runProgram(tree, syntaxTree, options);
+        return;
+    }
 
     // 输出语法树
     parser.outputTree(syntaxTree, "parse_out.txt");
+}
 
-    // 释放内存
-    delete syntaxTree;
+// symbols 是本次会话的驻留表：词法分析器已经驻留的单词符号直接用编号，
+// 其余（单词符号文件、流水线模式）由语法树在建节点时驻留
+template <typename TokenSource, typename AfterParse>
+void parseTokens(TokenSource &source, StringInterner &symbols, const ParseOptions &options, AfterParse afterParse)
+{
+    if (options.pointerTree)
+        parseInto<PointerTree>(source, symbols, options, afterParse);
+    else
+        parseInto<FlatTree>(source, symbols, options, afterParse);
+}
+
+// 主函数
+// 用法：parse [--pipeline | --tokens | --text] [--pointer-tree] [--fold] [--run | --vm | --jit | --dump-bytecode | --dump-ssa | --emit-c | --compile] [源程序文件]
+//   默认在进程内对源程序（默认 source.txt）做词法分析，语法分析器边分析边拉取单词符号，
+//   不产生中间文件，也不保存整个单词符号序列
+//   --pipeline 词法分析在独立线程上运行，经无锁队列按批交给语法分析，结束后把各阶段耗时报告到标准错误
+//   --tokens 改为映射 text_lexer 输出的二进制单词符号文件 lex_out.bin
+//   --text 改为读取文本格式的 lex_out.txt 并打印每个token（调试用；指定了执行或输出动作时打印到标准错误）
+//   --pointer-tree 用指针树代替默认的扁平语法树（对照用）
+//   --run 不输出语法树，而是用树遍历解释器执行程序，read / write 读写标准输入输出
+//   --vm 同 --run，但先编译成寄存器字节码，由虚拟机执行
+//   --jit 同 --vm，但把字节码翻译成 x86-64 机器码直接执行；不是 x86-64 Linux 等情况下退回虚拟机
+//   --dump-bytecode 输出字节码的反汇编，不执行
+//   --dump-ssa 输出 SSA 形式的中间表示（基本块、phi、带类型的值），不执行
+//   --emit-c 输出等价的独立 C 程序（read / write 用缓冲的标准输入输出），不执行
+//   --fold 与上面各项合用（不能单独使用）：执行或输出之前先做常量折叠和代数化简，节点的统计输出到标准错误
+//   --compile 把 C 程序写到 parse_out.c，再调用本机的 C 编译器（$CC、cc 或 gcc）生成 parse_out
+int main(int argc, char *argv[])
+{
+    string path = "source.txt";
+    bool pipelined = false, tokenInput = false, textInput = false;
+    ParseOptions options;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--pipeline") {
+            pipelined = true;
+        } else if (arg == "--tokens") {
+            tokenInput = true;
+        } else if (arg == "--text") {
+            textInput = true;
+        } else if (arg == "--pointer-tree") {
+            options.pointerTree = true;
+        } else if (arg == "--fold") {
+            options.fold = true;
+        } else if (arg == "--run") {
+            options.action = ACTION_RUN;
+        } else if (arg == "--vm") {
+            options.action = ACTION_VM;
+        } else if (arg == "--jit") {
+            options.action = ACTION_JIT;
+        } else if (arg == "--dump-bytecode") {
+            options.action = ACTION_DUMP_BYTECODE;
+        } else if (arg == "--dump-ssa") {
+            options.action = ACTION_DUMP_SSA;
+        } else if (arg == "--emit-c") {
+            options.action = ACTION_EMIT_C;
+        } else if (arg == "--compile") {
+            options.action = ACTION_COMPILE;
+        } else {
+            path = arg;
+        }
+    }
+    // 折叠作用在解析后的 Program 上，只输出语法树时没有可折叠的东西
+    if (options.fold && options.action == ACTION_TREE) {
+        cerr << "--fold needs one of --run, --vm, --jit, --dump-bytecode, --dump-ssa, --emit-c, --compile" << endl;
+        exit(1);
+    }
+
+    // 标识符和常量的驻留表，词法分析器和语法树共用
+    StringInterner symbols;
+
+    if (textInput) {
+        TokenBlock textTokens;
+        readTokens("lex_out.txt", textTokens);
+        TokenArray tokens(textTokens);
+        // 执行程序或输出 C 源程序等时标准输出留给结果，单词符号列表改到标准错误
+        ostream &tokenLog = options.action == ACTION_TREE ? cout : cerr;
+        for (size_t i = 0; i < tokens.size(); ++i)
+        {
+            tokenLog << "Token: type=" << tokens[i].type << ", value=" << tokens[i].value << endl;
+        }
+        TokenArrayReader reader(tokens);
+        parseTokens(reader, symbols, options, [] {});
+    } else if (tokenInput) {
+        TokenFile tokenFile;
+        string message;
+        if (!tokenFile.open("lex_out.bin", message)) {
+            cerr << "Can't open input file: " << message << endl;
+            exit(1);
+        }
+        TokenArrayReader reader(tokenFile.array());
+        parseTokens(reader, symbols, options, [] {});
+    } else if (pipelined) {
+        MappedFile input;
+        if (!input.open(path)) {
+            cerr << "Can't open input file: " << path << endl;
+            exit(1);
+        }
+        PipelinedLexer lexer(input.view());
+        parseTokens(lexer, symbols, options, [&] { lexer.finish(); });
+
+        auto ms = [](chrono::nanoseconds t) { return chrono::duration<double, milli>(t).count(); };
+        const StageTimes &lex = lexer.lexStage(), &parse = lexer.parseStage();
+        cerr << "lex:   busy " << ms(lex.busy) << " ms, stall " << ms(lex.stall) << " ms" << endl;
+        cerr << "parse: busy " << ms(parse.busy) << " ms, stall " << ms(parse.stall) << " ms" << endl;
+    } else {
+        // 源程序直接映射，单词符号的值指向映射区，整个分析期间有效
+        MappedFile input;
+        if (!input.open(path)) {
+            cerr << "Can't open input file: " << path << endl;
+            exit(1);
+        }
+        Lexer lexer(input.view());
+        lexer.internSymbols(symbols);
+        parseTokens(lexer, symbols, options, [] {});
+    }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -72,28 +72,23 @@ private:
     TreeNode* parseStmts();
     
     // 查看当前token
-    Token peek() const {
-        if (current < tokens.size()) {
-            return tokens[current];
-        }
-        return {TOKEN_ERROR, ""};
+    const Token& peek() const {
+        return tokens[current];
     }
     
     // 查看前一个token
-    Token previous() const {
-        if (current > 0) {
-            return tokens[current - 1];
-        }
-        return {TOKEN_ERROR, ""};
+    const Token& previous() const {
+        return current > 0 ? tokens[current - 1] : tokens.back();
     }
     
     // 检查是否到达末尾
     bool isAtEnd() const {
-        return peek().type == TOKEN_ERROR && peek().value.empty();
+        const Token& token = peek();
+        return token.type == TOKEN_ERROR && token.value.empty();
     }
     
     // 前进到下一个token
-    Token advance() {
+    const Token& advance() {
         if (!isAtEnd()) current++;
         return previous();
     }
@@ -105,15 +100,14 @@ private:
     }
     
     // 检查当前token是否匹配给定类型和值
-    bool check(TokenType type, const string& value) const {
-        if (isAtEnd()) return false;
-        return peek().type == type && peek().value == value;
+    bool check(TokenType type, string_view value) const {
+        const Token& token = peek();
+        return token.type == type && token.value == value && !isAtEnd();
     }
     
     // 检查当前token是否匹配给定值（类型不限）
-    bool check(const string& value) const {
-        if (isAtEnd()) return false;
-        return peek().value == value;
+    bool check(string_view value) const {
+        return peek().value == value && !isAtEnd();
     }
     
     // 匹配给定类型
@@ -126,7 +120,7 @@ private:
     }
     
     // 匹配给定类型和值
-    bool match(TokenType type, const string& value) {
+    bool match(TokenType type, string_view value) {
         if (check(type, value)) {
             advance();
             return true;
@@ -135,7 +129,7 @@ private:
     }
     
     // 匹配给定值（类型不限）
-    bool match(const string& value) {
+    bool match(string_view value) {
         if (check(value)) {
             advance();
             return true;
@@ -159,7 +153,7 @@ private:
     }
     
     // 消耗一个token（指定值和类型），如果不匹配则报错
-    void consume(TokenType type, const string& value, const string& message) {
+    void consume(TokenType type, string_view value, const string& message) {
         if (check(type, value)) {
             advance();
             return;
@@ -168,7 +162,7 @@ private:
     }
     
     // 消耗一个token（指定值），如果不匹配则报错
-    void consume(const string& value, const string& message) {
+    void consume(string_view value, const string& message) {
         if (check(value)) {
             advance();
             return;
@@ -568,7 +562,10 @@ private:
     }
 
 public:
-    Parser(const vector<Token>& t) : tokens(t) {}
+    // 末尾追加一个输入结束标记，peek() 不必再检查下标
+    Parser(const vector<Token>& t) : tokens(t) {
+        tokens.push_back({TOKEN_ERROR, ""});
+    }
     
     // 解析入口
     TreeNode* parse() {
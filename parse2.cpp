@@ -89,33 +89,26 @@ private:
     }
 
     // 查看当前token
-    Token peek() const
+    const Token &peek() const
     {
-        if (current < tokens.size())
-        {
-            return tokens[current];
-        }
-        return {TOKEN_ERROR, ""};
+        return tokens[current];
     }
 
     // 查看前一个token
-    Token previous() const
+    const Token &previous() const
     {
-        if (current > 0)
-        {
-            return tokens[current - 1];
-        }
-        return {TOKEN_ERROR, ""};
+        return current > 0 ? tokens[current - 1] : tokens.back();
     }
 
     // 检查是否到达末尾
     bool isAtEnd() const
     {
-        return peek().type == TOKEN_ERROR && peek().value.empty();
+        const Token &token = peek();
+        return token.type == TOKEN_ERROR && token.value.empty();
     }
 
     // 前进到下一个token
-    Token advance()
+    const Token &advance()
     {
         if (!isAtEnd())
             current++;
@@ -131,19 +124,16 @@ private:
     }
 
     // 检查当前token是否匹配给定类型和值
-    bool check(TokenType type, const string &value) const
+    bool check(TokenType type, string_view value) const
     {
-        if (isAtEnd())
-            return false;
-        return peek().type == type && peek().value == value;
+        const Token &token = peek();
+        return token.type == type && token.value == value && !isAtEnd();
     }
 
     // 检查当前token是否匹配给定值（类型不限）
-    bool check(const string &value) const
+    bool check(string_view value) const
     {
-        if (isAtEnd())
-            return false;
-        return peek().value == value;
+        return peek().value == value && !isAtEnd();
     }
 
     // 匹配给定类型
@@ -158,7 +148,7 @@ private:
     }
 
     // 匹配给定类型和值
-    bool match(TokenType type, const string &value)
+    bool match(TokenType type, string_view value)
     {
         if (check(type, value))
         {
@@ -169,7 +159,7 @@ private:
     }
 
     // 匹配给定值（类型不限）
-    bool match(const string &value)
+    bool match(string_view value)
     {
         if (check(value))
         {
@@ -198,7 +188,7 @@ private:
     }
 
     // 消耗一个token（指定值和类型），如果不匹配则报错
-    void consume(TokenType type, const string &value, const string &message)
+    void consume(TokenType type, string_view value, const string &message)
     {
         if (check(type, value))
         {
@@ -209,7 +199,7 @@ private:
     }
 
     // 消耗一个token（指定值），如果不匹配则报错
-    void consume(const string &value, const string &message)
+    void consume(string_view value, const string &message)
     {
         if (check(value))
         {
@@ -747,7 +737,11 @@ private:
     }
 
 public:
-    Parser(const vector<Token> &t) : tokens(t) {}
+    // 末尾追加一个输入结束标记，peek() 不必再检查下标
+    Parser(const vector<Token> &t) : tokens(t)
+    {
+        tokens.push_back({TOKEN_ERROR, ""});
+    }
 
     // 解析入口
     TreeNode *parse()
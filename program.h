@@ -0,0 +1,418 @@
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ast.h"
+using namespace std;
+
+// 变量和表达式的类型
+enum ValueType : unsigned char {
+    TYPE_INT,   // int，64 位整数
+    TYPE_FLOAT, // float，双精度浮点数
+    TYPE_BOOL   // bool
+};
+
+inline const char* valueTypeToString(ValueType type) {
+    switch (type) {
+    case TYPE_INT:   return "int";
+    case TYPE_FLOAT: return "float";
+    case TYPE_BOOL:  return "bool";
+    default:         return "unknown";
+    }
+}
+
+// 运行时的值。类型在名字解析时已经确定，值本身不带类型标记
+union Value {
+    int64_t i;
+    double f;
+    bool b;
+};
+
+// 可执行节点的操作。语法树经过名字解析和类型检查后变成这种形式：
+// 变量换成槽号，运算按操作数类型选定整数或浮点版本，隐式类型转换显式插入，
+// 执行时不再查名字，也不再判断类型
+enum ExecOp : unsigned char {
+    // 语句
+    X_SEQ,      // 语句序列，lists[a, a + b) 是各条语句
+    X_ASSIGN,   // 槽 a = 表达式 b
+    X_INC,      // 槽 a 加一，type 为变量类型（int 或 float）
+    X_DEC,      // 槽 a 减一
+    X_IF,       // if (a) b else c，没有 else 时 c 为 NO_NODE
+    X_WHILE,    // while (a) b
+    X_FOR,      // for (a; b; c) d，省略的部分为 NO_NODE
+    X_READ,     // 依次读入槽 lists[a, a + b)
+    X_WRITE,    // 依次输出槽 lists[a, a + b)，空格分隔，末尾换行
+    // 表达式，结果类型为 type
+    X_CONST,    // 常数 value
+    X_LOAD,     // 槽 a 的值
+    X_ADD_I, X_SUB_I, X_MUL_I, X_DIV_I,
+    X_ADD_F, X_SUB_F, X_MUL_F, X_DIV_F,
+    X_EQ_I, X_NE_I, X_LT_I, X_LE_I, X_GT_I, X_GE_I,
+    X_EQ_F, X_NE_F, X_LT_F, X_LE_F, X_GT_F, X_GE_F,
+    X_EQ_B, X_NE_B,
+    X_AND, X_OR, // 短路求值
+    X_NOT,
+    X_NEG_I, X_NEG_F,
+    X_I2F,      // int -> float
+    X_F2I,      // float -> int，向零截断
+    X_I2B,      // 数值作条件：不等于 0 为真
+    X_F2B
+};
+
+constexpr uint32_t NO_NODE = UINT32_MAX;
+
+struct ExecNode {
+    ExecOp op;
+    ValueType type; // 表达式的结果类型；X_INC / X_DEC 的变量类型
+    uint32_t a = NO_NODE, b = NO_NODE, c = NO_NODE, d = NO_NODE; // 子节点下标、槽号或 lists 中的区间
+    Value value = {}; // X_CONST 的值
+};
+
+// 解析后的程序：节点按创建顺序存放，子节点先于父节点
+struct Program {
+    vector<ExecNode> nodes;
+    vector<uint32_t> lists;      // X_SEQ 的语句、X_READ / X_WRITE 的槽
+    vector<ValueType> slotTypes; // 槽 -> 变量类型
+    vector<string> slotNames;    // 槽 -> 变量名（诊断用）
+    uint32_t root = NO_NODE;     // 整个程序的语句序列
+};
+
+// 名字解析与类型检查：把语法树（FlatTree 或 PointerTree）转换成 Program。
+// 每个声明分配一个槽，标识符按驻留编号查当前可见的槽；变量必须先声明后使用，
+// 作用域为全局和 for 语句（for 初始化部分声明的变量只在该 for 语句内可见）
+template <typename Tree>
+class Resolver {
+private:
+    using Node = typename Tree::Node;
+
+    struct Error {
+        string message;
+    };
+
+    // 进入作用域前的绑定，离开作用域时恢复
+    struct Binding {
+        uint32_t symbol;
+        uint32_t slot; // 槽号 + 1，0 表示之前没有绑定
+    };
+
+    const Tree& tree;
+    Program& program;
+    vector<uint32_t> visible;    // 驻留编号 -> 当前可见的槽号 + 1，0 表示未声明
+    vector<uint32_t> slotDepth;  // 槽 -> 声明所在的作用域深度
+    vector<Binding> shadowed;    // 按进入顺序保存被遮蔽的绑定
+    uint32_t depth = 0;
+    vector<Node> children;       // 子节点暂存栈，各层递归共用
+    vector<uint32_t> pending;    // 语句序列暂存栈，各层递归共用
+
+    [[noreturn]] void fail(const string& message) {
+        throw Error{message};
+    }
+
+    // 把 node 的子节点压入 children，返回起始位置；用完后由调用方弹出
+    size_t pushChildren(Node node) {
+        size_t start = children.size();
+        tree.forEachChild(node, [&](Node child) { children.push_back(child); });
+        return start;
+    }
+
+    uint32_t add(const ExecNode& node) {
+        program.nodes.push_back(node);
+        return (uint32_t)program.nodes.size() - 1;
+    }
+
+    // 把 pending[start, end) 移到 lists 中，返回 lists 中的起始位置
+    uint32_t takeList(size_t start) {
+        uint32_t first = (uint32_t)program.lists.size();
+        program.lists.insert(program.lists.end(), pending.begin() + start, pending.end());
+        pending.resize(start);
+        return first;
+    }
+
+    uint32_t lookup(Node id) {
+        uint32_t symbol = tree.valueId(id);
+        if (symbol >= visible.size() || visible[symbol] == 0) {
+            fail("Undeclared variable: " + string(tree.value(id)));
+        }
+        return visible[symbol] - 1;
+    }
+
+    uint32_t declare(Node id, ValueType type) {
+        uint32_t symbol = tree.valueId(id);
+        if (symbol >= visible.size()) visible.resize(symbol + 1, 0);
+        uint32_t previous = visible[symbol];
+        if (previous != 0 && slotDepth[previous - 1] == depth) {
+            fail("Redeclared variable: " + string(tree.value(id)));
+        }
+        uint32_t slot = (uint32_t)program.slotTypes.size();
+        program.slotTypes.push_back(type);
+        program.slotNames.emplace_back(tree.value(id));
+        slotDepth.push_back(depth);
+        if (depth > 0) shadowed.push_back({symbol, previous});
+        visible[symbol] = slot + 1;
+        return slot;
+    }
+
+    // 离开作用域，恢复 mark 之后被遮蔽的绑定
+    void leaveScope(size_t mark) {
+        while (shadowed.size() > mark) {
+            visible[shadowed.back().symbol] = shadowed.back().slot;
+            shadowed.pop_back();
+        }
+        --depth;
+    }
+
+    // 插入隐式类型转换：int 与 float 互转，数值作 bool 时与 0 比较；bool 不能转成数值
+    uint32_t convert(uint32_t expr, ValueType to) {
+        ValueType from = program.nodes[expr].type;
+        if (from == to) return expr;
+        if (from == TYPE_BOOL) {
+            fail(string("Can't convert bool to ") + valueTypeToString(to));
+        }
+        ExecOp op;
+        if (to == TYPE_BOOL) {
+            op = from == TYPE_INT ? X_I2B : X_F2B;
+        } else {
+            op = to == TYPE_FLOAT ? X_I2F : X_F2I;
+        }
+        return add({op, to, expr});
+    }
+
+    // 算术运算的操作数类型：有一个是 float 时都按 float 计算
+    ValueType numericType(uint32_t left, uint32_t right, string_view op) {
+        ValueType l = program.nodes[left].type, r = program.nodes[right].type;
+        if (l == TYPE_BOOL || r == TYPE_BOOL) {
+            fail("Operator " + string(op) + " needs numeric operands");
+        }
+        return (l == TYPE_FLOAT || r == TYPE_FLOAT) ? TYPE_FLOAT : TYPE_INT;
+    }
+
+    uint32_t resolveBinary(string_view op, uint32_t left, uint32_t right) {
+        static const string_view arithmetic[] = {"+", "-", "*", "/"};
+        static const string_view compare[] = {"==", "!=", "<", "<=", ">", ">="};
+
+        for (int i = 0; i < 4; ++i) {
+            if (op != arithmetic[i]) continue;
+            ValueType type = numericType(left, right, op);
+            ExecOp base = type == TYPE_FLOAT ? X_ADD_F : X_ADD_I;
+            return add({(ExecOp)(base + i), type, convert(left, type), convert(right, type)});
+        }
+        for (int i = 0; i < 6; ++i) {
+            if (op != compare[i]) continue;
+            if (i < 2 && program.nodes[left].type == TYPE_BOOL && program.nodes[right].type == TYPE_BOOL) {
+                return add({(ExecOp)(X_EQ_B + i), TYPE_BOOL, left, right});
+            }
+            ValueType type = numericType(left, right, op);
+            ExecOp base = type == TYPE_FLOAT ? X_EQ_F : X_EQ_I;
+            return add({(ExecOp)(base + i), TYPE_BOOL, convert(left, type), convert(right, type)});
+        }
+        if (op == "&&" || op == "||") {
+            return add({op == "&&" ? X_AND : X_OR, TYPE_BOOL, convert(left, TYPE_BOOL), convert(right, TYPE_BOOL)});
+        }
+        fail("Operator " + string(op) + " is not supported in expressions");
+    }
+
+    uint32_t resolveExpr(Node node) {
+        switch (tree.type(node)) {
+        case NODE_EXPR: {
+            size_t start = pushChildren(node);
+            Node inner = children[start];
+            children.resize(start);
+            return resolveExpr(inner);
+        }
+        case NODE_ID: {
+            uint32_t slot = lookup(node);
+            return add({X_LOAD, program.slotTypes[slot], slot});
+        }
+        case NODE_NUM: {
+            ExecNode constant = {X_CONST, TYPE_INT};
+            constant.value.i = tree.literal(node).i;
+            return add(constant);
+        }
+        case NODE_FLOAT: {
+            ExecNode constant = {X_CONST, TYPE_FLOAT};
+            constant.value.f = tree.literal(node).f;
+            return add(constant);
+        }
+        case NODE_BOOLVAL: {
+            ExecNode constant = {X_CONST, TYPE_BOOL};
+            constant.value.b = tree.value(node) == "true";
+            return add(constant);
+        }
+        case NODE_OP:
+            break;
+        default:
+            fail(string("Unexpected ") + nodeTypeToString(tree.type(node)) + " node in expression");
+        }
+
+        string_view op = tree.value(node);
+        size_t start = pushChildren(node);
+        size_t count = children.size() - start;
+        Node first = children[start];
+        Node second = count > 1 ? children[start + 1] : Tree::NONE;
+        children.resize(start);
+
+        if (count == 1) {
+            if (op == "neg") {
+                uint32_t operand = resolveExpr(first);
+                ValueType type = numericType(operand, operand, "-");
+                return add({type == TYPE_FLOAT ? X_NEG_F : X_NEG_I, type, operand});
+            }
+            if (op == "!") {
+                return add({X_NOT, TYPE_BOOL, convert(resolveExpr(first), TYPE_BOOL)});
+            }
+            fail("Operator " + string(op) + " is only supported as a statement");
+        }
+        uint32_t left = resolveExpr(first);
+        uint32_t right = resolveExpr(second);
+        return resolveBinary(op, left, right);
+    }
+
+    // 声明：TYPE 后跟若干 ID，ID 后面可以跟初始化表达式；没有初始化的变量置 0
+    uint32_t resolveDecl(Node list) {
+        size_t start = pushChildren(list);
+        size_t end = children.size();
+        string_view typeName = tree.value(children[start]);
+        ValueType type = typeName == "float" ? TYPE_FLOAT : typeName == "bool" ? TYPE_BOOL : TYPE_INT;
+
+        size_t first = pending.size();
+        for (size_t i = start + 1; i < end; ++i) {
+            Node id = children[i];
+            uint32_t init;
+            if (i + 1 < end && tree.type(children[i + 1]) == NODE_EXPR) {
+                init = convert(resolveExpr(children[++i]), type); // 初始化表达式在变量声明之前解析
+            } else {
+                init = add({X_CONST, type});
+            }
+            pending.push_back(add({X_ASSIGN, type, declare(id, type), init}));
+        }
+        children.resize(start);
+        uint32_t listStart = takeList(first);
+        return add({X_SEQ, TYPE_INT, listStart, (uint32_t)(program.lists.size() - listStart)});
+    }
+
+    // 语句序列：BLOCK、STMTS、DECLS 的子节点依次解析
+    uint32_t resolveSeq(Node node) {
+        size_t start = pushChildren(node);
+        size_t end = children.size();
+        size_t first = pending.size();
+        for (size_t i = start; i < end; ++i) {
+            Node child = children[i];
+            pending.push_back(resolveStmt(child));
+        }
+        children.resize(start);
+        uint32_t listStart = takeList(first);
+        return add({X_SEQ, TYPE_INT, listStart, (uint32_t)(program.lists.size() - listStart)});
+    }
+
+    // read / write 的变量列表
+    uint32_t resolveIo(Node node, ExecOp op) {
+        size_t start = pushChildren(node);
+        size_t first = pending.size();
+        for (size_t i = start; i < children.size(); ++i) {
+            pending.push_back(lookup(children[i]));
+        }
+        children.resize(start);
+        uint32_t listStart = takeList(first);
+        return add({op, TYPE_INT, listStart, (uint32_t)(program.lists.size() - listStart)});
+    }
+
+    uint32_t resolveAssign(Node node) {
+        string_view op = tree.value(node);
+        size_t start = pushChildren(node);
+        size_t count = children.size() - start;
+        Node id = children[start];
+        Node value = count > 1 ? children[start + 1] : Tree::NONE;
+        children.resize(start);
+
+        uint32_t slot = lookup(id);
+        ValueType type = program.slotTypes[slot];
+        if (op == "++" || op == "--") {
+            if (type == TYPE_BOOL) {
+                fail("Operator " + string(op) + " needs a numeric variable: " + program.slotNames[slot]);
+            }
+            return add({op == "++" ? X_INC : X_DEC, type, slot});
+        }
+        if (op != "=" || value == Tree::NONE) {
+            fail("Unsupported assignment operator: " + string(op));
+        }
+        return add({X_ASSIGN, type, slot, convert(resolveExpr(value), type)});
+    }
+
+    uint32_t resolveStmt(Node node) {
+        switch (tree.type(node)) {
+        case NODE_BLOCK:
+        case NODE_STMTS:
+        case NODE_DECLS:
+            return resolveSeq(node);
+        case NODE_LIST:
+            return resolveDecl(node);
+        case NODE_ASSIGN:
+            return resolveAssign(node);
+        case NODE_READ:
+            return resolveIo(node, X_READ);
+        case NODE_WRITE:
+            return resolveIo(node, X_WRITE);
+        case NODE_IF:
+        case NODE_WHILE:
+        case NODE_FOR:
+            break;
+        default:
+            fail(string("Unexpected ") + nodeTypeToString(tree.type(node)) + " node in statement");
+        }
+
+        NodeType type = tree.type(node);
+        size_t start = pushChildren(node);
+        Node parts[4] = {Tree::NONE, Tree::NONE, Tree::NONE, Tree::NONE};
+        for (size_t i = start; i < children.size() && i - start < 4; ++i) {
+            parts[i - start] = children[i];
+        }
+        children.resize(start);
+
+        if (type == NODE_IF) {
+            uint32_t cond = convert(resolveExpr(parts[0]), TYPE_BOOL);
+            uint32_t thenBranch = resolveStmt(parts[1]);
+            uint32_t elseBranch = parts[2] == Tree::NONE ? NO_NODE : resolveStmt(parts[2]);
+            return add({X_IF, TYPE_INT, cond, thenBranch, elseBranch});
+        }
+        if (type == NODE_WHILE) {
+            uint32_t cond = convert(resolveExpr(parts[0]), TYPE_BOOL);
+            return add({X_WHILE, TYPE_INT, cond, resolveStmt(parts[1])});
+        }
+
+        // for 语句自成一个作用域
+        size_t mark = shadowed.size();
+        ++depth;
+        uint32_t init = parts[0] == Tree::NONE ? NO_NODE : resolveStmt(parts[0]);
+        uint32_t cond = parts[1] == Tree::NONE ? NO_NODE : convert(resolveExpr(parts[1]), TYPE_BOOL);
+        uint32_t update = parts[2] == Tree::NONE ? NO_NODE : resolveStmt(parts[2]);
+        uint32_t body = resolveStmt(parts[3]);
+        leaveScope(mark);
+        return add({X_FOR, TYPE_INT, init, cond, update, body});
+    }
+
+public:
+    Resolver(const Tree& t, Program& p) : tree(t), program(p) {}
+
+    // 解析整棵语法树，失败时 error 给出原因
+    bool resolve(Node root, string& error) {
+        try {
+            program.root = resolveStmt(root);
+            return true;
+        } catch (const Error& e) {
+            error = e.message;
+            return false;
+        }
+    }
+};
+
+// 由语法树构造 Program，失败时 error 给出原因（未声明的变量、类型不匹配等）
+template <typename Tree>
+bool resolveProgram(const Tree& tree, typename Tree::Node root, Program& program, string& error) {
+    Resolver<Tree> resolver(tree, program);
+    return resolver.resolve(root, error);
+}
+
+#endif // PROGRAM_H
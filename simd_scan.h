@@ -0,0 +1,246 @@
+#ifndef SIMD_SCAN_H
+#define SIMD_SCAN_H
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCAN_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// AVX2 版本需要编译器支持按函数指定目标指令集，并在运行时检测 CPU
+#if defined(SCAN_HAVE_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCAN_HAVE_AVX2 1
+#include <immintrin.h>
+#define SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// 词法分析用的批量扫描函数：每个函数从 p 开始向后扫描，返回第一个不满足条件的位置，
+// 找不到时返回 end
+
+// 空白字符：空格、\t \n \v \f \r
+inline bool isSpaceByte(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// 标识符字符：字母、数字、下划线
+inline bool isIdentByte(char c) {
+    return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || c == '_';
+}
+
+inline bool isDigitByte(char c) {
+    return c >= '0' && c <= '9';
+}
+
+inline unsigned countTrailingZeros(unsigned mask) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctz(mask);
+#else
+    unsigned n = 0;
+    while (!(mask & 1u)) {
+        mask >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// ---------- 标量版本 ----------
+
+inline const char* skipSpacesScalar(const char* p, const char* end) {
+    while (p < end && isSpaceByte(*p)) ++p;
+    return p;
+}
+
+// 查找块注释结束符 "*/"，返回指向 '*' 的指针
+inline const char* findCommentEndScalar(const char* p, const char* end) {
+    while (end - p >= 2) {
+        const char* star = (const char*)memchr(p, '*', (size_t)(end - p - 1));
+        if (!star) break;
+        if (star[1] == '/') return star;
+        p = star + 1;
+    }
+    return end;
+}
+
+inline const char* skipIdentScalar(const char* p, const char* end) {
+    while (p < end && isIdentByte(*p)) ++p;
+    return p;
+}
+
+inline const char* skipDigitsScalar(const char* p, const char* end) {
+    while (p < end && isDigitByte(*p)) ++p;
+    return p;
+}
+
+// ---------- SSE2 版本（每次 16 字节） ----------
+
+#ifdef SCAN_HAVE_SSE2
+inline __m128i spaceMask128(__m128i v) {
+    __m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+    __m128i control = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)),
+                                    _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1)));
+    return _mm_or_si128(space, control);
+}
+
+inline const char* skipSpacesSse2(const char* p, const char* end) {
+    // 多数空白串只有一两个字符，先用标量判断避免无谓的向量加载
+    if (p < end && !isSpaceByte(*p)) return p;
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        unsigned mask = (unsigned)_mm_movemask_epi8(spaceMask128(v)) ^ 0xFFFFu;
+        if (mask) return p + countTrailingZeros(mask);
+        p += 16;
+    }
+    return skipSpacesScalar(p, end);
+}
+
+// 有符号比较：0x80 以上的字节为负数，不会落入任何 ASCII 区间
+inline __m128i digitMask128(__m128i v) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+}
+
+inline __m128i identMask128(__m128i v) {
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                   _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+    __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(letter, underscore), digitMask128(v));
+}
+
+inline const char* skipIdentSse2(const char* p, const char* end) {
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        unsigned mask = (unsigned)_mm_movemask_epi8(identMask128(v)) ^ 0xFFFFu;
+        if (mask) return p + countTrailingZeros(mask);
+        p += 16;
+    }
+    return skipIdentScalar(p, end);
+}
+
+inline const char* skipDigitsSse2(const char* p, const char* end) {
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)p);
+        unsigned mask = (unsigned)_mm_movemask_epi8(digitMask128(v)) ^ 0xFFFFu;
+        if (mask) return p + countTrailingZeros(mask);
+        p += 16;
+    }
+    return skipDigitsScalar(p, end);
+}
+
+inline const char* findCommentEndSse2(const char* p, const char* end) {
+    const __m128i star = _mm_set1_epi8('*');
+    const __m128i slash = _mm_set1_epi8('/');
+    while (end - p >= 17) {
+        __m128i a = _mm_loadu_si128((const __m128i*)p);
+        __m128i b = _mm_loadu_si128((const __m128i*)(p + 1));
+        unsigned mask = (unsigned)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, star), _mm_cmpeq_epi8(b, slash)));
+        if (mask) return p + countTrailingZeros(mask);
+        p += 16;
+    }
+    return findCommentEndScalar(p, end);
+}
+#endif
+
+// ---------- AVX2 版本（每次 32 字节） ----------
+
+#ifdef SCAN_HAVE_AVX2
+SCAN_TARGET_AVX2 inline __m256i spaceMask256(__m256i v) {
+    __m256i space = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' '));
+    __m256i control = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('\t' - 1)),
+                                       _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), v));
+    return _mm256_or_si256(space, control);
+}
+
+SCAN_TARGET_AVX2 inline const char* skipSpacesAvx2(const char* p, const char* end) {
+    if (p < end && !isSpaceByte(*p)) return p;
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(spaceMask256(v));
+        if (mask) return p + countTrailingZeros(mask);
+        p += 32;
+    }
+    return skipSpacesSse2(p, end);
+}
+
+SCAN_TARGET_AVX2 inline __m256i digitMask256(__m256i v) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+}
+
+SCAN_TARGET_AVX2 inline __m256i identMask256(__m256i v) {
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                      _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+    __m256i underscore = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+    return _mm256_or_si256(_mm256_or_si256(letter, underscore), digitMask256(v));
+}
+
+SCAN_TARGET_AVX2 inline const char* skipIdentAvx2(const char* p, const char* end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(identMask256(v));
+        if (mask) return p + countTrailingZeros(mask);
+        p += 32;
+    }
+    return skipIdentSse2(p, end);
+}
+
+SCAN_TARGET_AVX2 inline const char* skipDigitsAvx2(const char* p, const char* end) {
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)p);
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(digitMask256(v));
+        if (mask) return p + countTrailingZeros(mask);
+        p += 32;
+    }
+    return skipDigitsSse2(p, end);
+}
+
+SCAN_TARGET_AVX2 inline const char* findCommentEndAvx2(const char* p, const char* end) {
+    const __m256i star = _mm256_set1_epi8('*');
+    const __m256i slash = _mm256_set1_epi8('/');
+    while (end - p >= 33) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)p);
+        __m256i b = _mm256_loadu_si256((const __m256i*)(p + 1));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(a, star), _mm256_cmpeq_epi8(b, slash)));
+        if (mask) return p + countTrailingZeros(mask);
+        p += 32;
+    }
+    return findCommentEndSse2(p, end);
+}
+#endif
+
+// ---------- 运行时选择 ----------
+
+struct ScanKernels {
+    const char* name;
+    const char* (*skipSpaces)(const char* p, const char* end);
+    const char* (*findCommentEnd)(const char* p, const char* end);
+    const char* (*skipIdent)(const char* p, const char* end);
+    const char* (*skipDigits)(const char* p, const char* end);
+};
+
+inline ScanKernels selectScanKernels() {
+#ifdef SCAN_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return {"avx2", skipSpacesAvx2, findCommentEndAvx2, skipIdentAvx2, skipDigitsAvx2};
+    }
+#endif
+#ifdef SCAN_HAVE_SSE2
+    return {"sse2", skipSpacesSse2, findCommentEndSse2, skipIdentSse2, skipDigitsSse2};
+#else
+    return {"scalar", skipSpacesScalar, findCommentEndScalar, skipIdentScalar, skipDigitsScalar};
+#endif
+}
+
+// 进程内只检测一次 CPU 特性
+inline const ScanKernels& scanKernels() {
+    static const ScanKernels kernels = selectScanKernels();
+    return kernels;
+}
+
+#endif // SIMD_SCAN_H
@@ -0,0 +1,932 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "program.h"
+using namespace std;
+
+// SSA 形式的中间表示。程序是一个函数：基本块组成控制流图，每条指令至多定义一个值，
+// 值只赋值一次，变量在汇合处用 phi 合并。指令与值一一对应，用下标 %n 引用：
+//   运算      a b 是运算数
+//   PHI       operands[a, a + b) 依次对应所在块的各前驱，c 是对应的变量槽（&& || 的结果为 NO_SLOT）
+//   READ      读入变量槽 a 的新值；WRITE 输出值 a；PUTC 输出字符 value.i
+//   JUMP      跳到块 a；BRANCH 值 a 为真时跳到块 b，否则跳到块 c；RETURN 结束程序
+// 常数都放在入口块开头。运算和比较的顺序与 ExecOp 一致
+#define SSA_OPS(X) \
+    X(CONST) X(PHI) \
+    X(ADD_I) X(SUB_I) X(MUL_I) X(DIV_I) X(ADD_F) X(SUB_F) X(MUL_F) X(DIV_F) \
+    X(EQ_I) X(NE_I) X(LT_I) X(LE_I) X(GT_I) X(GE_I) \
+    X(EQ_F) X(NE_F) X(LT_F) X(LE_F) X(GT_F) X(GE_F) X(EQ_B) X(NE_B) \
+    X(NOT) X(NEG_I) X(NEG_F) X(I2F) X(F2I) X(I2B) X(F2B) \
+    X(READ) X(WRITE) X(PUTC) \
+    X(JUMP) X(BRANCH) X(RETURN)
+
+enum SsaOp : uint8_t {
+#define SSA_ENUM(name) S_##name,
+    SSA_OPS(SSA_ENUM)
+#undef SSA_ENUM
+    S_OP_COUNT
+};
+
+inline const char* ssaOpName(SsaOp op) {
+    static const char* const names[] = {
+#define SSA_NAME(name) #name,
+        SSA_OPS(SSA_NAME)
+#undef SSA_NAME
+    };
+    return op < S_OP_COUNT ? names[op] : "?";
+}
+
+constexpr uint32_t NO_VALUE = UINT32_MAX;
+constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+inline bool ssaIsTerminator(SsaOp op) {
+    return op == S_JUMP || op == S_BRANCH || op == S_RETURN;
+}
+
+// 指令是否定义一个值
+inline bool ssaHasValue(SsaOp op) {
+    return op < S_WRITE;
+}
+
+struct SsaInst {
+    SsaOp op;
+    ValueType type; // 定义的值的类型
+    uint32_t a = NO_VALUE, b = NO_VALUE, c = NO_VALUE;
+    Value value = {}; // CONST 的值，PUTC 的字符
+};
+
+struct SsaBlock {
+    vector<uint32_t> preds; // 前驱块，顺序与 phi 的运算数一致
+    vector<uint32_t> insts; // phi 在最前面，最后一条是终结指令
+};
+
+// 块 0 是入口
+struct SsaFunction {
+    vector<SsaInst> insts;
+    vector<SsaBlock> blocks;
+    vector<uint32_t> operands; // phi 的运算数
+    vector<ValueType> slotTypes;
+    vector<string> slotNames;
+};
+
+// 由 Program 直接构造 SSA（Braun 等人的算法：按块记录每个变量的当前定义，
+// 读变量时沿前驱查找，需要时插入 phi；循环头在回边加入之前不"封闭"，其中的 phi 暂不填运算数）。
+// 结构化的控制流只产生可归约的图，去掉平凡 phi（运算数除自己外只有一个值）之后就是最小 SSA。
+// && || 按短路求值拆成分支和 phi，除法等可能出错的运算不会被提前求值
+class SsaBuilder {
+private:
+    struct PendingPhi {
+        uint32_t slot;
+        uint32_t phi;
+    };
+
+    const Program& program;
+    SsaFunction& out;
+    uint32_t current = 0;                          // 正在生成指令的块
+    vector<vector<uint32_t>> phis;                 // 块 -> phi（构造期间与其他指令分开存放）
+    vector<bool> sealed;                           // 块的前驱已经全部确定
+    vector<vector<PendingPhi>> incomplete;         // 未封闭的块中尚未填运算数的 phi
+    unordered_map<uint64_t, uint32_t> definitions; // (块, 变量槽) -> 当前的值
+    unordered_map<uint64_t, uint32_t> constants[3]; // 按类型：位模式 -> 常数值
+    vector<uint32_t> entryConstants;
+    vector<uint32_t> replacement;                  // 值 -> 被替换成的值（平凡 phi），未替换时是自己
+    vector<uint32_t> phiBlock;                     // 值 -> phi 所在的块
+
+    const ExecNode& node(uint32_t n) const {
+        return program.nodes[n];
+    }
+
+    uint32_t newBlock() {
+        out.blocks.emplace_back();
+        phis.emplace_back();
+        sealed.push_back(false);
+        incomplete.emplace_back();
+        return (uint32_t)out.blocks.size() - 1;
+    }
+
+    uint32_t newValue(const SsaInst& inst) {
+        out.insts.push_back(inst);
+        replacement.push_back((uint32_t)out.insts.size() - 1);
+        phiBlock.push_back(NO_VALUE);
+        return (uint32_t)out.insts.size() - 1;
+    }
+
+    uint32_t emit(SsaOp op, ValueType type, uint32_t a = NO_VALUE, uint32_t b = NO_VALUE, uint32_t c = NO_VALUE) {
+        SsaInst inst;
+        inst.op = op;
+        inst.type = type;
+        inst.a = a;
+        inst.b = b;
+        inst.c = c;
+        uint32_t v = newValue(inst);
+        out.blocks[current].insts.push_back(v);
+        return v;
+    }
+
+    void jump(uint32_t target) {
+        emit(S_JUMP, TYPE_INT, target);
+        out.blocks[target].preds.push_back(current);
+    }
+
+    void branch(uint32_t cond, uint32_t ifTrue, uint32_t ifFalse) {
+        emit(S_BRANCH, TYPE_INT, cond, ifTrue, ifFalse);
+        out.blocks[ifTrue].preds.push_back(current);
+        out.blocks[ifFalse].preds.push_back(current);
+    }
+
+    uint32_t constant(ValueType type, Value value) {
+        if (type == TYPE_BOOL) {
+            bool b = value.b;
+            value.i = 0;
+            value.b = b;
+        }
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        auto found = constants[type].find(bits);
+        if (found != constants[type].end()) return found->second;
+        SsaInst inst;
+        inst.op = S_CONST;
+        inst.type = type;
+        inst.value = value;
+        uint32_t v = newValue(inst);
+        constants[type][bits] = v;
+        entryConstants.push_back(v);
+        return v;
+    }
+
+    uint32_t zero(ValueType type) {
+        return constant(type, Value{});
+    }
+
+    uint32_t resolve(uint32_t v) {
+        while (replacement[v] != v) {
+            replacement[v] = replacement[replacement[v]];
+            v = replacement[v];
+        }
+        return v;
+    }
+
+    static uint64_t key(uint32_t block, uint32_t slot) {
+        return (uint64_t)block << 32 | slot;
+    }
+
+    void writeVariable(uint32_t slot, uint32_t block, uint32_t v) {
+        definitions[key(block, slot)] = v;
+    }
+
+    uint32_t readVariable(uint32_t slot, uint32_t block) {
+        auto found = definitions.find(key(block, slot));
+        if (found != definitions.end()) return resolve(found->second);
+        const vector<uint32_t>& preds = out.blocks[block].preds;
+        uint32_t v;
+        if (!sealed[block]) {
+            v = newPhi(block, slot);
+            incomplete[block].push_back({slot, v});
+        } else if (preds.empty()) {
+            v = zero(program.slotTypes[slot]); // 入口（或不可达的块）：变量的初值
+        } else if (preds.size() == 1) {
+            v = readVariable(slot, preds[0]);
+        } else {
+            v = newPhi(block, slot);
+            writeVariable(slot, block, v); // 先记下，打断经过循环的递归
+            v = addPhiOperands(slot, v);
+        }
+        writeVariable(slot, block, v);
+        return v;
+    }
+
+    uint32_t newPhi(uint32_t block, uint32_t slot) {
+        SsaInst inst;
+        inst.op = S_PHI;
+        inst.type = slot == NO_SLOT ? TYPE_BOOL : program.slotTypes[slot];
+        inst.b = 0;
+        inst.c = slot;
+        uint32_t v = newValue(inst);
+        phis[block].push_back(v);
+        phiBlock[v] = block;
+        return v;
+    }
+
+    // phi 的运算数一次放进 operands（读前驱时可能递归地填别的 phi，先收集再追加）
+    uint32_t addPhiOperands(uint32_t slot, uint32_t phi) {
+        vector<uint32_t> values;
+        for (uint32_t pred : out.blocks[phiBlock[phi]].preds) values.push_back(readVariable(slot, pred));
+        setPhiOperands(phi, values);
+        return removeTrivialPhi(phi);
+    }
+
+    void setPhiOperands(uint32_t phi, const vector<uint32_t>& values) {
+        out.insts[phi].a = (uint32_t)out.operands.size();
+        out.insts[phi].b = (uint32_t)values.size();
+        out.operands.insert(out.operands.end(), values.begin(), values.end());
+    }
+
+    // 运算数除自己外只有一个值的 phi 换成那个值
+    uint32_t removeTrivialPhi(uint32_t phi) {
+        uint32_t same = NO_VALUE;
+        const SsaInst& inst = out.insts[phi];
+        for (uint32_t i = 0; i < inst.b; ++i) {
+            uint32_t v = resolve(out.operands[inst.a + i]);
+            if (v == same || v == phi) continue;
+            if (same != NO_VALUE) return phi;
+            same = v;
+        }
+        if (same == NO_VALUE) same = zero(inst.type); // 只引用自己：不可达
+        replacement[phi] = same;
+        return same;
+    }
+
+    void seal(uint32_t block) {
+        for (const PendingPhi& p : incomplete[block]) addPhiOperands(p.slot, p.phi);
+        incomplete[block].clear();
+        sealed[block] = true;
+    }
+
+    uint32_t value(uint32_t n) {
+        const ExecNode& x = node(n);
+        switch (x.op) {
+        case X_CONST:
+            return constant(x.type, x.value);
+        case X_LOAD:
+            return readVariable(x.a, current);
+        case X_AND:
+        case X_OR:
+            return shortCircuit(x);
+        default:
+            break;
+        }
+        if (x.op >= X_ADD_I && x.op <= X_NE_B) {
+            uint32_t left = value(x.a);
+            uint32_t right = value(x.b);
+            return emit((SsaOp)(S_ADD_I + (x.op - X_ADD_I)), x.type, left, right);
+        }
+        uint32_t operand = value(x.a);
+        return emit((SsaOp)(S_NOT + (x.op - X_NOT)), x.type, operand);
+    }
+
+    // a && b：a 为假时直接到汇合块，结果为 false；a || b 类似
+    uint32_t shortCircuit(const ExecNode& x) {
+        uint32_t left = value(x.a);
+        uint32_t right = newBlock(), join = newBlock();
+        if (x.op == X_AND) {
+            branch(left, right, join);
+        } else {
+            branch(left, join, right);
+        }
+        seal(right);
+        current = right;
+        uint32_t rightValue = value(x.b);
+        jump(join);
+        seal(join);
+        current = join;
+        uint32_t phi = newPhi(join, NO_SLOT);
+        setPhiOperands(phi, {constant(TYPE_BOOL, boolValue(x.op == X_OR)), rightValue});
+        return phi;
+    }
+
+    static Value boolValue(bool b) {
+        Value v;
+        v.i = 0;
+        v.b = b;
+        return v;
+    }
+
+    static Value intValue(int64_t i) {
+        Value v;
+        v.i = i;
+        return v;
+    }
+
+    static Value floatValue(double f) {
+        Value v;
+        v.f = f;
+        return v;
+    }
+
+    void statement(uint32_t n) {
+        const ExecNode& x = node(n);
+        switch (x.op) {
+        case X_SEQ:
+            for (uint32_t i = 0; i < x.b; ++i) statement(program.lists[x.a + i]);
+            return;
+        case X_ASSIGN:
+            writeVariable(x.a, current, value(x.b));
+            return;
+        case X_INC:
+        case X_DEC: {
+            uint32_t old = readVariable(x.a, current);
+            bool isInt = x.type == TYPE_INT;
+            uint32_t one = isInt ? constant(TYPE_INT, intValue(1)) : constant(TYPE_FLOAT, floatValue(1.0));
+            SsaOp op = x.op == X_INC ? (isInt ? S_ADD_I : S_ADD_F) : (isInt ? S_SUB_I : S_SUB_F);
+            writeVariable(x.a, current, emit(op, x.type, old, one));
+            return;
+        }
+        case X_IF: {
+            uint32_t cond = value(x.a);
+            uint32_t then = newBlock();
+            uint32_t otherwise = x.c != NO_NODE ? newBlock() : NO_VALUE;
+            uint32_t join = newBlock();
+            branch(cond, then, otherwise != NO_VALUE ? otherwise : join);
+            seal(then);
+            current = then;
+            statement(x.b);
+            jump(join);
+            if (otherwise != NO_VALUE) {
+                seal(otherwise);
+                current = otherwise;
+                statement(x.c);
+                jump(join);
+            }
+            seal(join);
+            current = join;
+            return;
+        }
+        case X_WHILE:
+            loop(x.a, x.b, NO_NODE);
+            return;
+        case X_FOR:
+            if (x.a != NO_NODE) statement(x.a);
+            loop(x.b, x.d, x.c);
+            return;
+        case X_READ:
+            for (uint32_t i = 0; i < x.b; ++i) {
+                uint32_t slot = program.lists[x.a + i];
+                writeVariable(slot, current, emit(S_READ, program.slotTypes[slot], slot));
+            }
+            return;
+        case X_WRITE:
+            for (uint32_t i = 0; i < x.b; ++i) {
+                if (i > 0) putChar(' ');
+                emit(S_WRITE, TYPE_INT, readVariable(program.lists[x.a + i], current));
+            }
+            putChar('\n');
+            return;
+        default:
+            return;
+        }
+    }
+
+    void putChar(char c) {
+        uint32_t v = emit(S_PUTC, TYPE_INT);
+        out.insts[v].value.i = c;
+    }
+
+    // 循环头在回边加入后才封闭；没有条件时出口块没有前驱（不可达，最后删除）
+    void loop(uint32_t cond, uint32_t body, uint32_t step) {
+        uint32_t header = newBlock();
+        jump(header);
+        current = header;
+        uint32_t bodyBlock = newBlock(), exit = newBlock();
+        if (cond != NO_NODE) {
+            branch(value(cond), bodyBlock, exit);
+        } else {
+            jump(bodyBlock);
+        }
+        seal(bodyBlock);
+        current = bodyBlock;
+        statement(body);
+        if (step != NO_NODE) statement(step);
+        jump(header);
+        seal(header);
+        seal(exit);
+        current = exit;
+    }
+
+    // 构造结束后的整理：删除不可达的块，反复去掉平凡 phi，删除没人用的 phi 和常数，
+    // 把所有引用换成最终的值，按块的顺序重新编号
+    void finish() {
+        size_t count = out.blocks.size();
+        for (uint32_t b = 0; b < count; ++b) {
+            out.blocks[b].insts.insert(out.blocks[b].insts.begin(), phis[b].begin(), phis[b].end());
+        }
+        out.blocks[0].insts.insert(out.blocks[0].insts.begin(), entryConstants.begin(), entryConstants.end());
+
+        // 可达的块
+        vector<bool> reachable(count, false);
+        vector<uint32_t> stack = {0};
+        reachable[0] = true;
+        while (!stack.empty()) {
+            uint32_t b = stack.back();
+            stack.pop_back();
+            const SsaInst& last = out.insts[out.blocks[b].insts.back()];
+            uint32_t targets[2] = {last.op == S_JUMP ? last.a : last.b, last.op == S_BRANCH ? last.c : NO_VALUE};
+            if (last.op == S_RETURN) continue;
+            for (uint32_t t : targets) {
+                if (t != NO_VALUE && !reachable[t]) {
+                    reachable[t] = true;
+                    stack.push_back(t);
+                }
+            }
+        }
+
+        // 去掉来自不可达前驱的边和对应的 phi 运算数
+        for (uint32_t b = 0; b < count; ++b) {
+            if (!reachable[b]) continue;
+            SsaBlock& block = out.blocks[b];
+            vector<bool> keep(block.preds.size());
+            bool all = true;
+            for (size_t i = 0; i < block.preds.size(); ++i) {
+                keep[i] = reachable[block.preds[i]];
+                all = all && keep[i];
+            }
+            if (all) continue;
+            for (uint32_t v : block.insts) {
+                SsaInst& inst = out.insts[v];
+                if (inst.op != S_PHI || replacement[v] != v) continue;
+                vector<uint32_t> values;
+                for (uint32_t i = 0; i < inst.b; ++i) {
+                    if (keep[i]) values.push_back(out.operands[inst.a + i]);
+                }
+                setPhiOperands(v, values);
+            }
+            vector<uint32_t> preds;
+            for (size_t i = 0; i < block.preds.size(); ++i) {
+                if (keep[i]) preds.push_back(block.preds[i]);
+            }
+            block.preds.swap(preds);
+        }
+
+        // 平凡 phi 可能因为别的 phi 被替换而变得平凡，做到不再变化为止
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (uint32_t b = 0; b < count; ++b) {
+                if (!reachable[b]) continue;
+                for (uint32_t v : out.blocks[b].insts) {
+                    if (out.insts[v].op == S_PHI && replacement[v] == v && removeTrivialPhi(v) != v) changed = true;
+                }
+            }
+        }
+
+        // 引用换成最终的值，统计使用次数
+        vector<uint32_t> uses(out.insts.size(), 0);
+        auto use = [&](uint32_t& v) {
+            v = resolve(v);
+            ++uses[v];
+        };
+        for (uint32_t b = 0; b < count; ++b) {
+            if (!reachable[b]) continue;
+            for (uint32_t v : out.blocks[b].insts) {
+                if (replacement[v] != v) continue;
+                SsaInst& inst = out.insts[v];
+                if (inst.op == S_PHI) {
+                    for (uint32_t i = 0; i < inst.b; ++i) use(out.operands[inst.a + i]);
+                } else if (inst.op != S_CONST && inst.op != S_READ && inst.op != S_PUTC && inst.op != S_JUMP &&
+                           inst.op != S_RETURN) {
+                    use(inst.a);
+                    if (inst.op != S_BRANCH && inst.b != NO_VALUE) use(inst.b);
+                }
+            }
+        }
+
+        // 没人用的 phi 和常数（构造过程的副产品）逐个删除，删掉的 phi 可能让别的 phi 也没人用
+        vector<bool> dead(out.insts.size(), false);
+        vector<uint32_t> work;
+        for (uint32_t b = 0; b < count; ++b) {
+            if (!reachable[b]) continue;
+            for (uint32_t v : out.blocks[b].insts) {
+                SsaOp op = out.insts[v].op;
+                if (replacement[v] != v) {
+                    dead[v] = true;
+                } else if ((op == S_PHI || op == S_CONST) && uses[v] == 0) {
+                    work.push_back(v);
+                }
+            }
+        }
+        while (!work.empty()) {
+            uint32_t v = work.back();
+            work.pop_back();
+            if (dead[v]) continue;
+            dead[v] = true;
+            const SsaInst& inst = out.insts[v];
+            if (inst.op != S_PHI) continue;
+            for (uint32_t i = 0; i < inst.b; ++i) {
+                uint32_t u = out.operands[inst.a + i];
+                if (--uses[u] == 0 && (out.insts[u].op == S_PHI || out.insts[u].op == S_CONST)) work.push_back(u);
+            }
+        }
+
+        renumber(reachable, dead);
+    }
+
+    void renumber(const vector<bool>& reachable, const vector<bool>& dead) {
+        vector<uint32_t> blockIndex(out.blocks.size(), NO_VALUE);
+        vector<uint32_t> valueIndex(out.insts.size(), NO_VALUE);
+        uint32_t blocks = 0, values = 0;
+        for (uint32_t b = 0; b < out.blocks.size(); ++b) {
+            if (!reachable[b]) continue;
+            blockIndex[b] = blocks++;
+            for (uint32_t v : out.blocks[b].insts) {
+                if (!dead[v]) valueIndex[v] = values++;
+            }
+        }
+
+        SsaFunction result;
+        result.slotTypes = out.slotTypes;
+        result.slotNames = out.slotNames;
+        result.insts.resize(values);
+        result.blocks.resize(blocks);
+        for (uint32_t b = 0; b < out.blocks.size(); ++b) {
+            if (!reachable[b]) continue;
+            SsaBlock& block = result.blocks[blockIndex[b]];
+            for (uint32_t p : out.blocks[b].preds) block.preds.push_back(blockIndex[p]);
+            for (uint32_t v : out.blocks[b].insts) {
+                if (dead[v]) continue;
+                SsaInst inst = out.insts[v];
+                switch (inst.op) {
+                case S_PHI: {
+                    uint32_t first = (uint32_t)result.operands.size();
+                    for (uint32_t i = 0; i < inst.b; ++i) {
+                        result.operands.push_back(valueIndex[out.operands[inst.a + i]]);
+                    }
+                    inst.a = first;
+                    break;
+                }
+                case S_CONST:
+                case S_READ:
+                case S_PUTC:
+                case S_RETURN:
+                    break;
+                case S_JUMP:
+                    inst.a = blockIndex[inst.a];
+                    break;
+                case S_BRANCH:
+                    inst.a = valueIndex[inst.a];
+                    inst.b = blockIndex[inst.b];
+                    inst.c = blockIndex[inst.c];
+                    break;
+                default:
+                    inst.a = valueIndex[inst.a];
+                    if (inst.b != NO_VALUE) inst.b = valueIndex[inst.b];
+                    break;
+                }
+                block.insts.push_back(valueIndex[v]);
+                result.insts[valueIndex[v]] = inst;
+            }
+        }
+        out = move(result);
+    }
+
+public:
+    SsaBuilder(const Program& p, SsaFunction& f) : program(p), out(f) {}
+
+    void build() {
+        out = SsaFunction();
+        out.slotTypes = program.slotTypes;
+        out.slotNames = program.slotNames;
+        current = newBlock();
+        seal(current);
+        statement(program.root);
+        emit(S_RETURN, TYPE_INT);
+        finish();
+    }
+};
+
+inline void buildSsa(const Program& program, SsaFunction& function) {
+    SsaBuilder builder(program, function);
+    builder.build();
+}
+
+// 检查 SSA 的结构：每个块以一条终结指令结束，phi 都在块首且运算数个数等于前驱个数，
+// 前驱表与各块的跳转一致，运算数的类型符合指令的要求，每个值的定义支配它的所有使用
+// （phi 的运算数要支配对应前驱块的末尾）。不合法时返回 false，error 指出第一个问题
+class SsaVerifier {
+private:
+    struct Error {
+        string message;
+    };
+
+    const SsaFunction& function;
+    vector<uint32_t> defBlock;    // 值 -> 所在块
+    vector<uint32_t> defPosition; // 值 -> 在块中的位置
+    vector<uint32_t> idom;        // 块 -> 直接支配者
+    vector<uint32_t> rpoIndex;    // 块 -> 逆后序编号
+
+    [[noreturn]] static void fail(const string& message) {
+        throw Error{message};
+    }
+
+    static string valueName(uint32_t v) {
+        return "%" + to_string(v);
+    }
+
+    static string blockName(uint32_t b) {
+        return "b" + to_string(b);
+    }
+
+    void targets(const SsaInst& inst, vector<uint32_t>& out) const {
+        if (inst.op == S_JUMP) out.push_back(inst.a);
+        if (inst.op == S_BRANCH) {
+            out.push_back(inst.b);
+            out.push_back(inst.c);
+        }
+    }
+
+    void checkStructure() {
+        const vector<SsaBlock>& blocks = function.blocks;
+        if (blocks.empty()) fail("no blocks");
+        if (!blocks[0].preds.empty()) fail("entry block has predecessors");
+        defBlock.assign(function.insts.size(), NO_VALUE);
+        defPosition.assign(function.insts.size(), 0);
+        vector<vector<uint32_t>> preds(blocks.size());
+        for (uint32_t b = 0; b < blocks.size(); ++b) {
+            const SsaBlock& block = blocks[b];
+            if (block.insts.empty()) fail(blockName(b) + " is empty");
+            bool body = false;
+            for (uint32_t i = 0; i < block.insts.size(); ++i) {
+                uint32_t v = block.insts[i];
+                if (v >= function.insts.size()) fail(blockName(b) + " lists unknown value " + valueName(v));
+                if (defBlock[v] != NO_VALUE) fail(valueName(v) + " appears twice");
+                defBlock[v] = b;
+                defPosition[v] = i;
+                const SsaInst& inst = function.insts[v];
+                if (inst.op >= S_OP_COUNT) fail(valueName(v) + " has a bad opcode");
+                if (inst.op == S_PHI) {
+                    if (body) fail(blockName(b) + ": phi " + valueName(v) + " after other instructions");
+                    if (inst.b != block.preds.size()) {
+                        fail(blockName(b) + ": phi " + valueName(v) + " has " + to_string(inst.b) + " operands for " +
+                             to_string(block.preds.size()) + " predecessors");
+                    }
+                } else {
+                    body = true;
+                }
+                bool last = i + 1 == block.insts.size();
+                if (ssaIsTerminator(inst.op) != last) {
+                    fail(blockName(b) + (last ? " doesn't end with a terminator" : ": terminator in the middle"));
+                }
+                vector<uint32_t> successors;
+                targets(inst, successors);
+                for (uint32_t t : successors) {
+                    if (t >= blocks.size()) fail(valueName(v) + " jumps to unknown block " + blockName(t));
+                    preds[t].push_back(b);
+                }
+            }
+        }
+        for (uint32_t b = 0; b < blocks.size(); ++b) {
+            vector<uint32_t> expected = preds[b], listed = blocks[b].preds;
+            sort(expected.begin(), expected.end());
+            sort(listed.begin(), listed.end());
+            if (expected != listed) fail(blockName(b) + ": predecessor list doesn't match the jumps");
+        }
+    }
+
+    void checkTypes() {
+        for (const SsaBlock& block : function.blocks) {
+            for (uint32_t v : block.insts) checkType(v, function.insts[v]);
+        }
+    }
+
+    ValueType typeOf(uint32_t user, uint32_t v) const {
+        if (v >= function.insts.size() || defBlock[v] == NO_VALUE) {
+            fail(valueName(user) + " uses undefined value " + (v == NO_VALUE ? "(none)" : valueName(v)));
+        }
+        if (!ssaHasValue(function.insts[v].op)) fail(valueName(user) + " uses " + valueName(v) + ", which has no value");
+        return function.insts[v].type;
+    }
+
+    void expect(uint32_t user, uint32_t v, ValueType type) const {
+        ValueType actual = typeOf(user, v);
+        if (actual != type) {
+            fail(valueName(user) + " (" + ssaOpName(function.insts[user].op) + ") expects " + valueTypeToString(type) +
+                 " but " + valueName(v) + " is " + valueTypeToString(actual));
+        }
+    }
+
+    void result(uint32_t v, const SsaInst& inst, ValueType type) const {
+        if (inst.type != type) {
+            fail(valueName(v) + " (" + ssaOpName(inst.op) + ") should be " + valueTypeToString(type) + ", not " +
+                 valueTypeToString(inst.type));
+        }
+    }
+
+    void checkType(uint32_t v, const SsaInst& inst) const {
+        SsaOp op = inst.op;
+        if (op >= S_ADD_I && op <= S_NE_B) {
+            // 运算数类型：int 运算和比较、float 运算和比较、bool 比较
+            int k = op - S_ADD_I;
+            ValueType operand = k < 4 ? TYPE_INT : k < 8 ? TYPE_FLOAT : k < 14 ? TYPE_INT : k < 20 ? TYPE_FLOAT : TYPE_BOOL;
+            expect(v, inst.a, operand);
+            expect(v, inst.b, operand);
+            result(v, inst, k < 4 ? TYPE_INT : k < 8 ? TYPE_FLOAT : TYPE_BOOL);
+            return;
+        }
+        switch (op) {
+        case S_PHI:
+            for (uint32_t i = 0; i < inst.b; ++i) {
+                if (inst.a + i >= function.operands.size()) fail(valueName(v) + " has operands out of range");
+                expect(v, function.operands[inst.a + i], inst.type);
+            }
+            return;
+        case S_NOT:
+            expect(v, inst.a, TYPE_BOOL);
+            result(v, inst, TYPE_BOOL);
+            return;
+        case S_NEG_I:
+        case S_I2F:
+        case S_I2B:
+            expect(v, inst.a, TYPE_INT);
+            result(v, inst, op == S_NEG_I ? TYPE_INT : op == S_I2F ? TYPE_FLOAT : TYPE_BOOL);
+            return;
+        case S_NEG_F:
+        case S_F2I:
+        case S_F2B:
+            expect(v, inst.a, TYPE_FLOAT);
+            result(v, inst, op == S_NEG_F ? TYPE_FLOAT : op == S_F2I ? TYPE_INT : TYPE_BOOL);
+            return;
+        case S_READ:
+            if (inst.a >= function.slotTypes.size()) fail(valueName(v) + " reads unknown slot");
+            result(v, inst, function.slotTypes[inst.a]);
+            return;
+        case S_WRITE:
+            typeOf(v, inst.a);
+            return;
+        case S_BRANCH:
+            expect(v, inst.a, TYPE_BOOL);
+            return;
+        default:
+            return;
+        }
+    }
+
+    // 支配树（Cooper、Harvey、Kennedy 的迭代算法），不可达的块不参与
+    void computeDominators() {
+        size_t count = function.blocks.size();
+        vector<uint32_t> order; // 后序
+        vector<uint8_t> state(count, 0);
+        vector<pair<uint32_t, size_t>> stack = {{0, 0}};
+        state[0] = 1;
+        while (!stack.empty()) {
+            uint32_t b = stack.back().first;
+            vector<uint32_t> successors;
+            targets(function.insts[function.blocks[b].insts.back()], successors);
+            size_t& next = stack.back().second;
+            if (next < successors.size()) {
+                uint32_t s = successors[next++];
+                if (state[s] == 0) {
+                    state[s] = 1;
+                    stack.push_back({s, 0});
+                }
+            } else {
+                order.push_back(b);
+                stack.pop_back();
+            }
+        }
+        reverse(order.begin(), order.end());
+        rpoIndex.assign(count, NO_VALUE);
+        for (uint32_t i = 0; i < order.size(); ++i) rpoIndex[order[i]] = i;
+        idom.assign(count, NO_VALUE);
+        idom[0] = 0;
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (uint32_t i = 1; i < order.size(); ++i) {
+                uint32_t b = order[i];
+                uint32_t dom = NO_VALUE;
+                for (uint32_t p : function.blocks[b].preds) {
+                    if (idom[p] == NO_VALUE) continue;
+                    dom = dom == NO_VALUE ? p : intersect(p, dom);
+                }
+                if (idom[b] != dom) {
+                    idom[b] = dom;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    uint32_t intersect(uint32_t x, uint32_t y) const {
+        while (x != y) {
+            while (rpoIndex[x] > rpoIndex[y]) x = idom[x];
+            while (rpoIndex[y] > rpoIndex[x]) y = idom[y];
+        }
+        return x;
+    }
+
+    bool dominates(uint32_t a, uint32_t b) const {
+        while (true) {
+            if (a == b) return true;
+            if (b == 0 || idom[b] == NO_VALUE) return false;
+            b = idom[b];
+        }
+    }
+
+    // 值 def 在块 block 的第 position 条指令处可用
+    void checkAvailable(uint32_t user, uint32_t def, uint32_t block, uint32_t position) const {
+        uint32_t home = defBlock[def];
+        bool ok = home == block ? defPosition[def] < position : dominates(home, block);
+        if (!ok) fail(valueName(def) + " doesn't dominate its use in " + valueName(user));
+    }
+
+    void checkDominance() {
+        computeDominators();
+        for (uint32_t b = 0; b < function.blocks.size(); ++b) {
+            if (rpoIndex[b] == NO_VALUE) continue; // 不可达的块里的使用不会执行
+            const SsaBlock& block = function.blocks[b];
+            for (uint32_t i = 0; i < block.insts.size(); ++i) {
+                uint32_t v = block.insts[i];
+                const SsaInst& inst = function.insts[v];
+                if (inst.op == S_PHI) {
+                    for (uint32_t k = 0; k < inst.b; ++k) {
+                        uint32_t pred = block.preds[k];
+                        if (rpoIndex[pred] == NO_VALUE) continue;
+                        checkAvailable(v, function.operands[inst.a + k], pred,
+                                       (uint32_t)function.blocks[pred].insts.size());
+                    }
+                    continue;
+                }
+                if (inst.op == S_CONST || inst.op == S_READ || inst.op == S_PUTC || inst.op == S_JUMP ||
+                    inst.op == S_RETURN) {
+                    continue;
+                }
+                checkAvailable(v, inst.a, b, i);
+                if (inst.op >= S_ADD_I && inst.op <= S_NE_B) checkAvailable(v, inst.b, b, i);
+            }
+        }
+    }
+
+public:
+    explicit SsaVerifier(const SsaFunction& f) : function(f) {}
+
+    bool verify(string& error) {
+        try {
+            checkStructure();
+            checkTypes();
+            checkDominance();
+            return true;
+        } catch (const Error& e) {
+            error = e.message;
+            return false;
+        }
+    }
+};
+
+inline bool verifySsa(const SsaFunction& function, string& error) {
+    SsaVerifier verifier(function);
+    return verifier.verify(error);
+}
+
+// 文本形式，每行一条指令（调试用）
+inline void dumpSsa(const SsaFunction& function, ostream& out) {
+    out << "; " << function.blocks.size() << " blocks, " << function.insts.size() << " values\n";
+    for (uint32_t b = 0; b < function.blocks.size(); ++b) {
+        const SsaBlock& block = function.blocks[b];
+        out << "b" << b << ":";
+        if (!block.preds.empty()) {
+            out << "\t; preds";
+            for (size_t i = 0; i < block.preds.size(); ++i) out << (i ? ", b" : " b") << block.preds[i];
+        }
+        out << '\n';
+        for (uint32_t v : block.insts) {
+            const SsaInst& inst = function.insts[v];
+            out << '\t';
+            if (ssaHasValue(inst.op)) out << '%' << v << " = ";
+            out << ssaOpName(inst.op);
+            if (ssaHasValue(inst.op)) out << ' ' << valueTypeToString(inst.type);
+            switch (inst.op) {
+            case S_CONST:
+                if (inst.type == TYPE_INT) {
+                    out << ' ' << inst.value.i;
+                } else if (inst.type == TYPE_FLOAT) {
+                    char text[32];
+                    out << ' ' << string_view(text, (size_t)(to_chars(text, text + sizeof(text), inst.value.f).ptr - text));
+                } else {
+                    out << (inst.value.b ? " true" : " false");
+                }
+                break;
+            case S_PHI:
+                for (uint32_t i = 0; i < inst.b; ++i) {
+                    out << (i ? ", " : " ") << "[%" << function.operands[inst.a + i] << ", b" << block.preds[i] << "]";
+                }
+                if (inst.c != NO_SLOT) out << "\t; " << function.slotNames[inst.c];
+                break;
+            case S_READ:
+                out << ' ' << function.slotNames[inst.a];
+                break;
+            case S_PUTC:
+                out << ' ' << inst.value.i;
+                break;
+            case S_JUMP:
+                out << " b" << inst.a;
+                break;
+            case S_BRANCH:
+                out << " %" << inst.a << ", b" << inst.b << ", b" << inst.c;
+                break;
+            case S_RETURN:
+                break;
+            default:
+                out << " %" << inst.a;
+                if (inst.op >= S_ADD_I && inst.op <= S_NE_B) out << ", %" << inst.b;
+                break;
+            }
+            out << '\n';
+        }
+    }
+}
+
+#endif // SSA_H
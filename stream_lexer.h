@@ -0,0 +1,81 @@
+#ifndef STREAM_LEXER_H
+#define STREAM_LEXER_H
+
+#include <cerrno>
+#include <cstring>
+#include <istream>
+#include <vector>
+#include "lexer.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+using namespace std;
+
+// 流式词法分析器：按固定大小的块读取输入，内存占用只与块大小有关，
+// 跨越块边界的单词符号和注释在下一块读入后继续识别。
+// 单个单词符号比块还长时缓冲区才会扩大到能容纳它。
+// 返回的单词符号 value 指向内部缓冲区，下一次调用 getNextToken 后失效。
+class StreamLexer {
+private:
+    istream* stream = nullptr;
+    int fd = -1;
+    vector<char> buffer;
+    size_t filled = 0; // 缓冲区中有效数据的长度
+    bool eof = false;
+    Lexer lexer;
+
+    // 读入最多 n 个字节，返回 0 表示输入结束
+    size_t readSome(char* dest, size_t n) {
+        if (stream) {
+            stream->read(dest, (streamsize)n);
+            return (size_t)stream->gcount();
+        }
+#ifndef _WIN32
+        while (true) {
+            ssize_t got = ::read(fd, dest, n);
+            if (got >= 0) return (size_t)got;
+            if (errno != EINTR) return 0;
+        }
+#else
+        return 0;
+#endif
+    }
+
+    // 丢弃已分析的部分，把未完成的部分移到缓冲区开头，再用新数据填满
+    void refill() {
+        size_t keep = lexer.position();
+        filled -= keep;
+        memmove(buffer.data(), buffer.data() + keep, filled);
+        if (filled == buffer.size()) {
+            buffer.resize(buffer.size() * 2); // 单词符号比整个缓冲区还长
+        }
+        while (!eof && filled < buffer.size()) {
+            size_t got = readSome(buffer.data() + filled, buffer.size() - filled);
+            if (got == 0) eof = true;
+            filled += got;
+        }
+        lexer.reset(string_view(buffer.data(), filled), eof);
+    }
+
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 1 << 16;
+
+    StreamLexer(istream& in, size_t chunkSize = DEFAULT_CHUNK_SIZE)
+        : stream(&in), buffer(chunkSize > 0 ? chunkSize : 1), lexer(string_view(), false) {}
+
+    // 从文件描述符读取（调用方负责关闭）
+    StreamLexer(int inputFd, size_t chunkSize = DEFAULT_CHUNK_SIZE)
+        : fd(inputFd), buffer(chunkSize > 0 ? chunkSize : 1), lexer(string_view(), false) {}
+
+    // 获取下一个单词符号，输入结束时返回 {TOKEN_ERROR, ""}
+    Token getNextToken() {
+        while (true) {
+            Token token = lexer.getNextToken();
+            if (!lexer.needMore()) return token;
+            refill();
+        }
+    }
+};
+
+#endif // STREAM_LEXER_H
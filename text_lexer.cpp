@@ -2,243 +2,181 @@
 #include <fstream>
 #include <string>
 #include <vector>
-#include <unordered_map>
-#include <cctype>
+#include "lexer.h"
+#include "mapped_file.h"
+#include "stream_lexer.h"
+#include "parallel_lexer.h"
+#include "token_file.h"
 using namespace std;
 
-// 单词符号类型编码
-enum TokenType {
-    TOKEN_ID,        // 标识符
-    TOKEN_NUM,       // 整常数
-    TOKEN_FLOAT,     // 浮点数
-    TOKEN_BOOL,      // 布尔常量
-    TOKEN_KEYWORD,   // 关键字
-    TOKEN_OP,        // 运算符
-    TOKEN_SEP,       // 分隔符
-    TOKEN_ERROR      // 错误
-};
-
-// 符号表：关键字
-unordered_map<string, TokenType> keywords = {
-    {"int", TOKEN_KEYWORD},
-    {"float", TOKEN_KEYWORD}, // 新增 float
-    {"bool", TOKEN_KEYWORD},
-    {"if", TOKEN_KEYWORD},
-    {"else", TOKEN_KEYWORD},
-    {"while", TOKEN_KEYWORD},
-    {"for", TOKEN_KEYWORD}, // 新增 for
-    {"read", TOKEN_KEYWORD},
-    {"write", TOKEN_KEYWORD},
-    {"true", TOKEN_BOOL},
-    {"false", TOKEN_BOOL}
-};
-
-// 符号表：运算符
-unordered_map<string, TokenType> operators = {
-    {"+", TOKEN_OP}, 
-    {"-", TOKEN_OP}, 
-    {"*", TOKEN_OP}, 
-    {"/", TOKEN_OP},
-    {"=", TOKEN_OP}, 
-    {"&", TOKEN_OP},
-    {"|", TOKEN_OP}, 
-    {"==", TOKEN_OP}, 
-    {"!=", TOKEN_OP}, 
-    {"<", TOKEN_OP},
-    {"<=", TOKEN_OP}, 
-    {">", TOKEN_OP}, 
-    {">=", TOKEN_OP}, 
-    {"&&", TOKEN_OP},
-    {"||", TOKEN_OP}, 
-    {"!", TOKEN_OP}, 
-    {"++", TOKEN_OP}, 
-    {"--", TOKEN_OP} // 添加自增、自减运算符
-};
-
+// 把单词符号格式化为 "(类型, 值)" 一行追加到 out
+void appendToken(string& out, const Token& token) {
+    out += '(';
+    out += char('0' + token.type);
+    out += ", ";
+    out += lexErrorText(token.error);
+    out.append(token.value.data(), token.value.size());
+    out += ")\n";
+}
+
+// 文本格式输出（调试用），每行一个 "(类型, 值)"
+class TextTokenWriter {
+private:
+    ofstream out;
 
-// 符号表：分隔符
-unordered_map<string, TokenType> separators = {
-    {";", TOKEN_SEP},
-    {",", TOKEN_SEP},
-    {"(", TOKEN_SEP},
-    {")", TOKEN_SEP},
-    {"{", TOKEN_SEP},
-    {"}", TOKEN_SEP}
-};
+public:
+    using Block = string;
 
-// 单词符号的二元组
-struct Token {
-    TokenType type;
-    string value;
-};
+    bool open(const string& path) {
+        out.open(path);
+        return (bool)out;
+    }
 
-// 词法分析器
-class Lexer {
-private:
-    string source; // 源程序
-    size_t pos = 0; // 当前扫描位置
+    static void add(Block& block, const Token& token) {
+        appendToken(block, token);
+    }
 
-    // 读取下一个字符
-    char peek() {
-        return (pos < source.length()) ? source[pos] : '\0';
+    void write(Block& block) {
+        out.write(block.data(), (streamsize)block.size());
+        block.clear();
     }
 
-    // 读取并移动指针
-    char advance() {
-        return (pos < source.length()) ? source[pos++] : '\0';
+    bool close() {
+        out.close();
+        return !out.fail();
     }
+};
 
-    // 跳过空白字符
-    void skipWhitespace() {
-        if (peek() == '/' && source[pos + 1] == '/') {
-            while (peek() != '\n' && peek() != '\0') advance();
-        }
-        if (peek() == '/' && source[pos + 1] == '*') {
-            advance(); // 跳过 '/'
-            advance(); // 跳过 '*'
-            while (!(peek() == '*' && source[pos + 1] == '/')) {
-                if (peek() == '\0') return; // 文件结束
-                advance();
+// 逐个取出单词符号，按批写出
+template <typename Writer, typename TokenSource>
+void writeTokens(TokenSource& lexer, Writer& writer) {
+    typename Writer::Block block;
+    size_t count = 0;
+    while (true) {
+        Token token = lexer.getNextToken();
+        if (token.type == TOKEN_ERROR && token.value.empty()) break;
+        Writer::add(block, token);
+        if (++count % 8192 == 0) writer.write(block);
+    }
+    writer.write(block);
+}
+
+// 多线程词法分析：按换行符把输入切段，各段并行分析并格式化，再按顺序写出。
+// 每轮处理 threads 段，输出缓冲区的总大小与段大小成正比，不随输入增长
+template <typename Writer>
+void writeTokensParallel(string_view source, unsigned threads, Writer& writer) {
+    const size_t minSegment = 1 << 20, maxSegment = 16 << 20;
+    size_t segmentSize = min(max(source.length() / threads + 1, minSegment), maxSegment);
+    vector<LexSegment> segments = splitSource(source, segmentSize, threads);
+
+    vector<typename Writer::Block> outputs(threads);
+    for (size_t first = 0; first < segments.size(); first += threads) {
+        size_t count = min<size_t>(threads, segments.size() - first);
+        runParallel(count, threads, [&](size_t i) {
+            const LexSegment& segment = segments[first + i];
+            Lexer lexer(segment.text);
+            lexer.setCommentState(segment.startState);
+            while (true) {
+                Token token = lexer.getNextToken();
+                if (token.type == TOKEN_ERROR && token.value.empty()) break;
+                Writer::add(outputs[i], token);
             }
-            advance(); // 跳过 '*'
-            advance(); // 跳过 '/'
+        });
+        for (size_t i = 0; i < count; ++i) {
+            writer.write(outputs[i]);
         }
-        while (isspace(peek())) advance();
     }
+}
 
-    // 识别标识符或关键字
-    Token recognizeIdOrKeyword() {
-        string value;
-        if (isdigit(peek())) {
-            // 如果以数字开头，则是非法标识符
-            while (isdigit(peek()) || isalpha(peek())) value += advance();
-            return {TOKEN_ERROR, "Illegal identifiers: " + value};
-        }
-        while (isalnum(peek()) || peek() == '_') value += advance();
-        if (keywords.find(value) != keywords.end()) {
-            return {keywords[value], value};
-        }
-        return {TOKEN_ID, value};
-    }
+struct LexOptions {
+    string path = "source.txt";
+    bool streaming = false;
+    size_t chunkSize = StreamLexer::DEFAULT_CHUNK_SIZE;
+    unsigned threads = 1;
+};
 
-    // 识别整常数或浮点数
-    Token recognizeNumber() {
-        string value;
-        bool hasDecimalPoint = false; // 是否包含小数点
-        bool isError = false; // 是否非法浮点数
-    
-        // 读取整数部分
-        while (isdigit(peek())) value += advance();
-    
-        // 读取小数点和小数部分
-        if (peek() == '.') {
-            value += advance(); // 读取小数点
-            hasDecimalPoint = true;
-    
-            // 读取小数部分
-            if (!isdigit(peek())) {
-                isError = true; // 小数点后没有数字，非法浮点数
-            } else {
-                while (isdigit(peek())) value += advance();
-            }
-    
-            // 检查是否有多余的小数点
-            if (peek() == '.') {
-                isError = true; // 多个小数点，非法浮点数
-                value += advance(); // 读取多余的小数点
-                while (isdigit(peek())) value += advance(); // 继续读取后续数字
+template <typename Writer>
+int runLexer(const LexOptions& options, Writer& writer) {
+    if (options.streaming) {
+        // 流式读取输入
+        ifstream inFile;
+        if (options.path != "-") {
+            inFile.open(options.path, ios::binary);
+            if (!inFile) {
+                cerr << "can't open " << options.path << endl;
+                return 1;
             }
         }
-    
-        // 检查是否以字母或其他非法字符结尾
-        if (isalpha(peek()) || peek() == '_') {
-            isError = true; // 数字后接字母或下划线，非法标识符
-            while (isalnum(peek()) || peek() == '_') value += advance(); // 继续读取后续字符
+        StreamLexer lexer(options.path == "-" ? cin : inFile, options.chunkSize);
+        writeTokens(lexer, writer);
+    } else {
+        // 读取源程序（普通文件直接映射，不复制）
+        MappedFile input;
+        if (!input.open(options.path)) {
+            cerr << "can't open " << options.path << endl;
+            return 1;
         }
-    
-        // 返回结果
-        if (isError) {
-            return {TOKEN_ERROR, "Illegal formatting: " + value};
-        } else if (hasDecimalPoint) {
-            return {TOKEN_FLOAT, value}; // 返回浮点数
+        if (options.threads > 1) {
+            writeTokensParallel(input.view(), options.threads, writer);
         } else {
-            return {TOKEN_NUM, value}; // 返回整常数
-        }
-    }
-
-    // 识别运算符或分隔符
-    Token recognizeOpOrSep() {
-        string value;
-        value += advance(); // 先读取一个字符
-    
-        // 处理双字符运算符（如 >=, <=, ==, !=, &&, ||）
-        if (operators.find(value + peek()) != operators.end()) {
-            value += advance();
-            return {operators[value], value};
-        }
-    
-        // 识别单字符运算符或分隔符
-        if (operators.find(value) != operators.end()) {
-            return {TOKEN_OP, value};
-        }
-        if (separators.find(value) != separators.end()) {
-            return {TOKEN_SEP, value};
+            Lexer lexer(input.view());
+            writeTokens(lexer, writer);
         }
-    
-        return {TOKEN_ERROR, "Illegal symbols: " + value};
     }
+    return 0;
+}
 
-
-public:
-    Lexer(const string& src) : source(src) {}
-
-    // 获取下一个单词符号
-    Token getNextToken() {
-        skipWhitespace();
-        char ch = peek();
-        if (isalpha(ch) || ch == '_') {
-            return recognizeIdOrKeyword();
-        } else if (isdigit(ch)) {
-            return recognizeNumber();
-        } else if (operators.find(string(1, ch)) != operators.end() || separators.find(string(1, ch)) != separators.end()) {
-            return recognizeOpOrSep();
-        } else if (ch == '\0') {
-            return {TOKEN_ERROR, ""};
+// 驱动模块
+// 用法：text_lexer [--text] [--stream] [--chunk=字节数] [--threads=线程数] [源程序文件]
+//   默认读取 source.txt，"-" 表示标准输入；输出二进制单词符号文件 lex_out.bin
+//   --text 改为输出文本格式的 lex_out.txt（调试用）
+//   --stream 按块读取输入，内存占用不随输入大小增长
+//   --threads 多线程分析，0 表示使用全部 CPU 核
+int main(int argc, char* argv[]) {
+    LexOptions options;
+    bool textOutput = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--text") {
+            textOutput = true;
+        } else if (arg == "--stream") {
+            options.streaming = true;
+        } else if (arg.rfind("--chunk=", 0) == 0) {
+            options.chunkSize = stoul(arg.substr(8));
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            options.threads = (unsigned)stoul(arg.substr(10));
+            if (options.threads == 0) options.threads = max(thread::hardware_concurrency(), 1u);
         } else {
-            advance();
-            return {TOKEN_ERROR, "Illegal characters: " + string(1, ch)};
+            options.path = arg;
         }
     }
-};
 
-// 驱动模块
-int main() {
-    // 读取源程序
-    ifstream inFile("source.txt");
-    if (!inFile) {
-        cerr << "can't open source.txt" << endl;
-        return 1;
+    string outPath = textOutput ? "lex_out.txt" : "lex_out.bin";
+    int result;
+    bool closed;
+    if (textOutput) {
+        TextTokenWriter writer;
+        if (!writer.open(outPath)) {
+            cerr << "can't output " << outPath << endl;
+            return 1;
+        }
+        result = runLexer(options, writer);
+        closed = writer.close();
+    } else {
+        TokenFileWriter writer;
+        if (!writer.open(outPath)) {
+            cerr << "can't output " << outPath << endl;
+            return 1;
+        }
+        result = runLexer(options, writer);
+        closed = writer.close();
     }
-    string source((istreambuf_iterator<char>(inFile)), istreambuf_iterator<char>());
-    inFile.close();
-
-    // 词法分析
-    Lexer lexer(source);
-    vector<Token> tokens;
-    ofstream outFile("lex_out.txt");
-    if (!outFile) {
-        cerr << "can't output lex_out.txt" << endl;
+    if (result != 0) return result;
+    if (!closed) {
+        cerr << "can't output " << outPath << endl;
         return 1;
     }
 
-    while (true) {
-        Token token = lexer.getNextToken();
-        if (token.type == TOKEN_ERROR && token.value.empty()) break;
-        tokens.push_back(token);
-        outFile << "(" << token.type << ", " << token.value << ")\n";
-    }
-    outFile.close();
-
-    cout << "lex success lex_out.txt" << endl;
+    cout << "lex success " << outPath << endl;
     return 0;
-}
\ No newline at end of file
+}
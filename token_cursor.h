@@ -0,0 +1,62 @@
+#ifndef TOKEN_CURSOR_H
+#define TOKEN_CURSOR_H
+
+#include <array>
+#include <cstddef>
+#include "lexer.h"
+using namespace std;
+
+// 输入结束标记，游标还没有前进时 previous() 也返回它
+inline constexpr Token END_TOKEN = {TOKEN_ERROR, ""};
+
+// 语法分析器读取单词符号的游标：按需从 TokenSource（任何提供 getNextToken() 的类型，
+// 输入结束时返回 {TOKEN_ERROR, ""}）拉取，只在一个小环形缓冲区里保留当前单词符号
+// 和之前取过的几个，内存占用不随单词符号数增长。
+// 单词符号的 value 直接引用 TokenSource 的缓冲区，因此 TokenSource 给出的切片
+// 必须在之后的几次 getNextToken 后仍然有效（Lexer 分析整块映射区时满足这一点）
+template <typename TokenSource>
+class TokenCursor {
+private:
+    static constexpr size_t RING_SIZE = 4; // 2 的幂，至少容纳当前和前一个单词符号
+
+    TokenSource& source;
+    array<Token, RING_SIZE> ring{};
+    size_t current = 0; // 当前单词符号的序号
+    bool ended = false; // 当前单词符号是否为输入结束标记
+
+    void fetch() {
+        Token& slot = ring[current & (RING_SIZE - 1)];
+        slot = source.getNextToken();
+        ended = slot.type == TOKEN_ERROR && slot.value.empty();
+    }
+
+public:
+    explicit TokenCursor(TokenSource& src) : source(src) {
+        fetch();
+    }
+
+    // 当前单词符号，输入结束后一直是 {TOKEN_ERROR, ""}
+    const Token& peek() const {
+        return ring[current & (RING_SIZE - 1)];
+    }
+
+    // 前一个单词符号，还没有前进过时是 END_TOKEN。
+    // 返回的引用在再前进 RING_SIZE - 1 次之后会被覆盖，需要保留更久时复制 Token（只含切片，不分配内存）
+    const Token& previous() const {
+        if (current == 0) return END_TOKEN;
+        return ring[(current - 1) & (RING_SIZE - 1)];
+    }
+
+    bool atEnd() const {
+        return ended;
+    }
+
+    // 前进到下一个单词符号，已到末尾时不动
+    void advance() {
+        if (ended) return;
+        ++current;
+        fetch();
+    }
+};
+
+#endif // TOKEN_CURSOR_H
@@ -0,0 +1,219 @@
+#ifndef TOKEN_FILE_H
+#define TOKEN_FILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "lexer.h"
+#include "mapped_file.h"
+using namespace std;
+
+// 二进制单词符号文件（词法分析器与语法分析器之间的默认交换格式，小端序）：
+//   TokenFileHeader                  文件头，24 字节
+//   TokenRecord[tokenCount]          定长记录，每条 24 字节
+//   char[poolSize]                   字符串池，记录中的 offset/length 指向这里
+// 语法分析器把整个文件映射进内存后直接按下标读取记录，不需要再解析文本
+
+constexpr char TOKEN_FILE_MAGIC[4] = {'T', 'L', 'X', 'B'};
+constexpr uint32_t TOKEN_FILE_VERSION = 3;
+
+struct TokenFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t tokenCount;
+    uint64_t poolSize;
+};
+
+struct TokenRecord {
+    uint8_t type;      // TokenType
+    uint8_t error;     // LexError，仅 TOKEN_ERROR 使用
+    uint8_t kind;      // TokenKind
+    uint8_t reserved;
+    uint32_t length;   // 单词符号文本长度
+    uint64_t offset;   // 单词符号文本在字符串池中的偏移
+    Literal literal;   // 常数的值，读取时不必再从文本转换
+};
+
+static_assert(sizeof(TokenFileHeader) == 24, "unexpected TokenFileHeader layout");
+static_assert(sizeof(TokenRecord) == 24, "unexpected TokenRecord layout");
+
+// 一段连续的单词符号：记录数组加上它们自己的字符串池
+struct TokenBlock {
+    vector<TokenRecord> records;
+    string pool;
+
+    void add(const Token& token) {
+        TokenRecord record = {(uint8_t)token.type, (uint8_t)token.error, (uint8_t)token.kind, 0,
+                              (uint32_t)token.value.size(), (uint64_t)pool.size(), token.literal};
+        records.push_back(record);
+        pool.append(token.value.data(), token.value.size());
+    }
+
+    void clear() {
+        records.clear();
+        pool.clear();
+    }
+};
+
+// 只读的单词符号数组（来自映射的文件，或内存中的 TokenBlock）
+class TokenArray {
+private:
+    const TokenRecord* records = nullptr;
+    size_t count = 0;
+    const char* pool = nullptr;
+
+public:
+    TokenArray() = default;
+    TokenArray(const TokenRecord* r, size_t n, const char* p) : records(r), count(n), pool(p) {}
+    TokenArray(const TokenBlock& block)
+        : records(block.records.data()), count(block.records.size()), pool(block.pool.data()) {}
+
+    size_t size() const {
+        return count;
+    }
+
+    Token operator[](size_t i) const {
+        const TokenRecord& r = records[i];
+        return {(TokenType)r.type, string_view(pool + r.offset, r.length), (LexError)r.error, (TokenKind)r.kind, 0,
+                r.literal};
+    }
+};
+
+// 按顺序逐个读出 TokenArray 中的单词符号，接口与 Lexer::getNextToken 相同
+class TokenArrayReader {
+private:
+    TokenArray tokens;
+    size_t next = 0;
+
+public:
+    explicit TokenArrayReader(const TokenArray& t) : tokens(t) {}
+
+    // 获取下一个单词符号，读完时返回 {TOKEN_ERROR, ""}
+    Token getNextToken() {
+        if (next < tokens.size()) return tokens[next++];
+        return {TOKEN_ERROR, ""};
+    }
+};
+
+// 写二进制单词符号文件：记录边产生边写出；字符串池先追加到临时文件，关闭时拷贝到记录之后并回填文件头。
+// 内存里只有当前这一段单词符号，占用不随输入大小增长（--stream 依赖这一点）
+class TokenFileWriter {
+private:
+    ofstream out;
+    FILE* poolFile = nullptr; // 字符串池的临时文件
+    uint64_t poolSize = 0;
+    uint64_t tokenCount = 0;
+    bool failed = false;
+
+public:
+    using Block = TokenBlock;
+
+    TokenFileWriter() = default;
+    TokenFileWriter(const TokenFileWriter&) = delete;
+    TokenFileWriter& operator=(const TokenFileWriter&) = delete;
+
+    ~TokenFileWriter() {
+        if (poolFile) fclose(poolFile);
+    }
+
+    bool open(const string& path) {
+        out.open(path, ios::binary | ios::trunc);
+        TokenFileHeader header = {};
+        out.write((const char*)&header, sizeof(header));
+        poolFile = tmpfile();
+        return out && poolFile;
+    }
+
+    static void add(Block& block, const Token& token) {
+        block.add(token);
+    }
+
+    // 写出一段单词符号，偏移量改为相对整个字符串池
+    void write(Block& block) {
+        for (TokenRecord& r : block.records) r.offset += poolSize;
+        out.write((const char*)block.records.data(), (streamsize)(block.records.size() * sizeof(TokenRecord)));
+        if (fwrite(block.pool.data(), 1, block.pool.size(), poolFile) != block.pool.size()) failed = true;
+        poolSize += block.pool.size();
+        tokenCount += block.records.size();
+        block.clear();
+    }
+
+    bool close() {
+        uint64_t copied = 0;
+        if (fflush(poolFile) != 0 || fseek(poolFile, 0, SEEK_SET) != 0) failed = true;
+        vector<char> buffer(1 << 16);
+        size_t n;
+        while (!failed && (n = fread(buffer.data(), 1, buffer.size(), poolFile)) > 0) {
+            out.write(buffer.data(), (streamsize)n);
+            copied += n;
+        }
+        if (ferror(poolFile) || copied != poolSize) failed = true;
+        fclose(poolFile);
+        poolFile = nullptr;
+
+        TokenFileHeader header;
+        memcpy(header.magic, TOKEN_FILE_MAGIC, sizeof(header.magic));
+        header.version = TOKEN_FILE_VERSION;
+        header.tokenCount = tokenCount;
+        header.poolSize = poolSize;
+        out.seekp(0);
+        out.write((const char*)&header, sizeof(header));
+        out.close();
+        return !out.fail() && !failed;
+    }
+};
+
+// 映射到内存的二进制单词符号文件
+class TokenFile {
+private:
+    MappedFile file;
+    TokenArray tokens;
+
+public:
+    // 打开并校验文件，失败时 error 给出原因
+    bool open(const string& path, string& error) {
+        if (!file.open(path)) {
+            error = "can't open " + path;
+            return false;
+        }
+        string_view data = file.view();
+        TokenFileHeader header;
+        if (data.size() < sizeof(header)) {
+            error = path + " is not a token file";
+            return false;
+        }
+        memcpy(&header, data.data(), sizeof(header));
+        if (memcmp(header.magic, TOKEN_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != TOKEN_FILE_VERSION) {
+            error = path + " is not a token file (bad magic or version)";
+            return false;
+        }
+        uint64_t recordBytes = header.tokenCount * sizeof(TokenRecord);
+        if (header.tokenCount > data.size() / sizeof(TokenRecord) || header.poolSize > data.size() ||
+            data.size() - sizeof(header) < recordBytes + header.poolSize) {
+            error = path + " is truncated";
+            return false;
+        }
+        const TokenRecord* records = (const TokenRecord*)(data.data() + sizeof(header));
+        const char* pool = data.data() + sizeof(header) + recordBytes;
+        for (uint64_t i = 0; i < header.tokenCount; ++i) {
+            const TokenRecord& r = records[i];
+            if (r.type > TOKEN_ERROR || r.kind >= KIND_COUNT || r.offset > header.poolSize || r.length > header.poolSize - r.offset) {
+                error = path + " has a corrupt token record";
+                return false;
+            }
+        }
+        tokens = TokenArray(records, (size_t)header.tokenCount, pool);
+        return true;
+    }
+
+    const TokenArray& array() const {
+        return tokens;
+    }
+};
+
+#endif // TOKEN_FILE_H
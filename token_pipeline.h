@@ -0,0 +1,172 @@
+#ifndef TOKEN_PIPELINE_H
+#define TOKEN_PIPELINE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string_view>
+#include <thread>
+#include "lexer.h"
+using namespace std;
+
+// 单生产者/单消费者无锁环形队列：槽位预先分配，生产者在 writeSlot() 上原地填好后 push()，
+// 消费者在 readSlot() 上读完后 pop()。head 只由消费者写，tail 只由生产者写
+template <typename T, size_t N>
+class SpscRing {
+private:
+    static_assert((N & (N - 1)) == 0, "ring size must be a power of two");
+
+    array<T, N> slots{};
+    alignas(64) atomic<size_t> head{0}; // 下一个要读的位置
+    alignas(64) atomic<size_t> tail{0}; // 下一个要写的位置
+
+public:
+    // 生产者：是否还有空槽
+    bool canPush() const {
+        return tail.load(memory_order_relaxed) - head.load(memory_order_acquire) < N;
+    }
+
+    T& writeSlot() {
+        return slots[tail.load(memory_order_relaxed) & (N - 1)];
+    }
+
+    void push() {
+        tail.store(tail.load(memory_order_relaxed) + 1, memory_order_release);
+    }
+
+    // 消费者：是否有已发布的槽
+    bool canPop() const {
+        return head.load(memory_order_relaxed) != tail.load(memory_order_acquire);
+    }
+
+    const T& readSlot() const {
+        return slots[head.load(memory_order_relaxed) & (N - 1)];
+    }
+
+    void pop() {
+        head.store(head.load(memory_order_relaxed) + 1, memory_order_release);
+    }
+};
+
+// 流水线各阶段的耗时统计（纳秒）
+struct StageTimes {
+    chrono::nanoseconds busy{0};  // 做实际工作的时间
+    chrono::nanoseconds stall{0}; // 等待另一阶段的时间
+};
+
+// 两线程流水线：词法分析在独立线程上运行，按批把单词符号放进 SPSC 环形队列，
+// 语法分析器在当前线程上通过 getNextToken() 消费。队列满时词法分析线程等待（反压），
+// 队列空时语法分析线程等待。单词符号的值指向源程序缓冲区，调用方须保证其在分析期间有效
+class PipelinedLexer {
+private:
+    static constexpr size_t BATCH_SIZE = 1024;
+    static constexpr size_t RING_SIZE = 16;
+
+    struct Batch {
+        array<Token, BATCH_SIZE> tokens;
+        size_t count = 0;
+        bool last = false; // 输入结束后的最后一批
+    };
+
+    using Clock = chrono::steady_clock;
+
+    SpscRing<Batch, RING_SIZE> ring;
+    atomic<bool> stopping{false};
+    thread worker;
+
+    // 生产者（词法分析线程）独占
+    StageTimes lexTimes;
+
+    // 消费者（调用 getNextToken 的线程）独占
+    StageTimes parseTimes;
+    const Batch* batch = nullptr; // 正在读的批
+    size_t index = 0;
+    bool ended = false;
+    Clock::time_point started = Clock::now();
+
+    // 词法分析线程：分析整个源程序，每满一批发布一次
+    void produce(string_view source) {
+        Clock::time_point begin = Clock::now();
+        Lexer lexer(source);
+        bool last = false;
+        while (!last) {
+            if (!ring.canPush()) {
+                Clock::time_point waitStart = Clock::now();
+                while (!ring.canPush() && !stopping.load(memory_order_relaxed)) {
+                    this_thread::yield();
+                }
+                lexTimes.stall += Clock::now() - waitStart;
+                if (!ring.canPush()) break; // 语法分析已提前结束
+            }
+            Batch& out = ring.writeSlot();
+            out.count = 0;
+            while (out.count < BATCH_SIZE) {
+                Token token = lexer.getNextToken();
+                if (token.type == TOKEN_ERROR && token.value.empty()) {
+                    last = true;
+                    break;
+                }
+                out.tokens[out.count++] = token;
+            }
+            out.last = last;
+            ring.push();
+        }
+        lexTimes.busy = Clock::now() - begin - lexTimes.stall;
+    }
+
+    // 取下一批，队列为空时等待词法分析线程
+    void nextBatch() {
+        if (batch) ring.pop();
+        if (!ring.canPop()) {
+            Clock::time_point waitStart = Clock::now();
+            while (!ring.canPop()) this_thread::yield();
+            parseTimes.stall += Clock::now() - waitStart;
+        }
+        batch = &ring.readSlot();
+        index = 0;
+    }
+
+public:
+    explicit PipelinedLexer(string_view source) {
+        worker = thread([this, source] { produce(source); });
+    }
+
+    PipelinedLexer(const PipelinedLexer&) = delete;
+    PipelinedLexer& operator=(const PipelinedLexer&) = delete;
+
+    ~PipelinedLexer() {
+        finish();
+    }
+
+    // 获取下一个单词符号，输入结束时返回 {TOKEN_ERROR, ""}
+    Token getNextToken() {
+        while (!ended) {
+            if (batch && index < batch->count) return batch->tokens[index++];
+            if (batch && batch->last) {
+                ended = true;
+                break;
+            }
+            nextBatch();
+        }
+        return {TOKEN_ERROR, ""};
+    }
+
+    // 停止并等待词法分析线程，之后统计数据才完整
+    void finish() {
+        if (!worker.joinable()) return;
+        stopping.store(true, memory_order_relaxed);
+        worker.join();
+        parseTimes.busy = Clock::now() - started - parseTimes.stall;
+    }
+
+    const StageTimes& lexStage() const {
+        return lexTimes;
+    }
+
+    const StageTimes& parseStage() const {
+        return parseTimes;
+    }
+};
+
+#endif // TOKEN_PIPELINE_H
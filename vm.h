@@ -0,0 +1,227 @@
+#ifndef VM_H
+#define VM_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "buffered_io.h"
+#include "bytecode.h"
+using namespace std;
+
+// GCC / Clang 支持取标号地址（&&label），用直接线索化分派：每条指令预先换成处理代码的地址，
+// 执行完一条指令直接跳到下一条的处理代码，每条指令有自己的间接跳转，分支预测更准。
+// 其他编译器退化为 switch 分派（也可以用 -DVM_THREADED=0 强制）
+#ifndef VM_THREADED
+#if defined(__GNUC__) || defined(__clang__)
+#define VM_THREADED 1
+#else
+#define VM_THREADED 0
+#endif
+#endif
+
+// 寄存器字节码虚拟机。寄存器就是变量槽、临时寄存器和常数，指令直接按下标读写；
+// 语义与树遍历解释器一致：整数运算回绕，整数除以 0 和 float 转 int 越界是运行时错误
+class VirtualMachine {
+private:
+    const Bytecode& bytecode;
+    vector<Value> registers;
+    BufferedInput& input;
+    BufferedOutput& output;
+
+#if VM_THREADED
+    struct ThreadedInstr {
+        const void* handler;
+        uint32_t a, b, c;
+    };
+#endif
+
+    static Value boolValue(bool b) {
+        Value v;
+        v.i = 0;
+        v.b = b;
+        return v;
+    }
+
+public:
+    VirtualMachine(const Bytecode& code, BufferedInput& in, BufferedOutput& out)
+        : bytecode(code), input(in), output(out) {}
+
+    // 执行整个程序，运行时错误时返回 false，error 给出原因（之前的输出已写出）
+    bool run(string& error) {
+        registers.assign(bytecode.registerCount, Value{});
+        for (size_t i = 0; i < bytecode.constants.size(); ++i) {
+            registers[bytecode.constantBase + i] = bytecode.constants[i];
+        }
+        Value* r = registers.data();
+
+#if VM_THREADED
+        static const void* const labels[] = {
+#define VM_LABEL(name) &&L_##name,
+            BYTECODE_OPS(VM_LABEL)
+#undef VM_LABEL
+        };
+        vector<ThreadedInstr> threaded(bytecode.code.size());
+        for (size_t i = 0; i < bytecode.code.size(); ++i) {
+            const Instr& instr = bytecode.code[i];
+            threaded[i] = {labels[instr.op], instr.a, instr.b, instr.c};
+        }
+        const ThreadedInstr* code = threaded.data();
+        const ThreadedInstr* ip = code;
+#define VM_CASE(name) L_##name:
+#define VM_DISPATCH() goto *ip->handler
+#else
+        const Instr* code = bytecode.code.data();
+        const Instr* ip = code;
+#define VM_CASE(name) case BC_##name:
+#define VM_DISPATCH() continue
+#endif
+#define VM_NEXT() { ++ip; VM_DISPATCH(); }
+#define VM_JUMP(cond) { if (cond) ip = code + ip->a; else ++ip; VM_DISPATCH(); }
+#define A r[ip->a]
+#define B r[ip->b]
+#define C r[ip->c]
+
+#if VM_THREADED
+        VM_DISPATCH();
+        {
+#else
+        for (;;) {
+            switch (ip->op) {
+#endif
+        VM_CASE(HALT)
+            output.flush();
+            return true;
+        VM_CASE(MOV)   A = B; VM_NEXT();
+        VM_CASE(JMP)   ip = code + ip->a; VM_DISPATCH();
+        VM_CASE(JT)    VM_JUMP(B.b);
+        VM_CASE(JF)    VM_JUMP(!B.b);
+
+        VM_CASE(ADD_I) A.i = (int64_t)((uint64_t)B.i + (uint64_t)C.i); VM_NEXT();
+        VM_CASE(SUB_I) A.i = (int64_t)((uint64_t)B.i - (uint64_t)C.i); VM_NEXT();
+        VM_CASE(MUL_I) A.i = (int64_t)((uint64_t)B.i * (uint64_t)C.i); VM_NEXT();
+        VM_CASE(DIV_I)
+            if (C.i == 0) {
+                error = "Division by zero";
+                goto fail;
+            }
+            A.i = C.i == -1 ? (int64_t)(0 - (uint64_t)B.i) : B.i / C.i;
+            VM_NEXT();
+        VM_CASE(ADD_F) A.f = B.f + C.f; VM_NEXT();
+        VM_CASE(SUB_F) A.f = B.f - C.f; VM_NEXT();
+        VM_CASE(MUL_F) A.f = B.f * C.f; VM_NEXT();
+        VM_CASE(DIV_F) A.f = B.f / C.f; VM_NEXT();
+
+        VM_CASE(EQ_I)  A = boolValue(B.i == C.i); VM_NEXT();
+        VM_CASE(NE_I)  A = boolValue(B.i != C.i); VM_NEXT();
+        VM_CASE(LT_I)  A = boolValue(B.i < C.i); VM_NEXT();
+        VM_CASE(LE_I)  A = boolValue(B.i <= C.i); VM_NEXT();
+        VM_CASE(GT_I)  A = boolValue(B.i > C.i); VM_NEXT();
+        VM_CASE(GE_I)  A = boolValue(B.i >= C.i); VM_NEXT();
+        VM_CASE(EQ_F)  A = boolValue(B.f == C.f); VM_NEXT();
+        VM_CASE(NE_F)  A = boolValue(B.f != C.f); VM_NEXT();
+        VM_CASE(LT_F)  A = boolValue(B.f < C.f); VM_NEXT();
+        VM_CASE(LE_F)  A = boolValue(B.f <= C.f); VM_NEXT();
+        VM_CASE(GT_F)  A = boolValue(B.f > C.f); VM_NEXT();
+        VM_CASE(GE_F)  A = boolValue(B.f >= C.f); VM_NEXT();
+        VM_CASE(EQ_B)  A = boolValue(B.b == C.b); VM_NEXT();
+        VM_CASE(NE_B)  A = boolValue(B.b != C.b); VM_NEXT();
+
+        VM_CASE(JEQ_I) VM_JUMP(B.i == C.i);
+        VM_CASE(JNE_I) VM_JUMP(B.i != C.i);
+        VM_CASE(JLT_I) VM_JUMP(B.i < C.i);
+        VM_CASE(JLE_I) VM_JUMP(B.i <= C.i);
+        VM_CASE(JGT_I) VM_JUMP(B.i > C.i);
+        VM_CASE(JGE_I) VM_JUMP(B.i >= C.i);
+        VM_CASE(JEQ_F) VM_JUMP(B.f == C.f);
+        VM_CASE(JNE_F) VM_JUMP(B.f != C.f);
+        VM_CASE(JLT_F) VM_JUMP(B.f < C.f);
+        VM_CASE(JLE_F) VM_JUMP(B.f <= C.f);
+        VM_CASE(JGT_F) VM_JUMP(B.f > C.f);
+        VM_CASE(JGE_F) VM_JUMP(B.f >= C.f);
+        VM_CASE(JNEQ_I) VM_JUMP(!(B.i == C.i));
+        VM_CASE(JNNE_I) VM_JUMP(!(B.i != C.i));
+        VM_CASE(JNLT_I) VM_JUMP(!(B.i < C.i));
+        VM_CASE(JNLE_I) VM_JUMP(!(B.i <= C.i));
+        VM_CASE(JNGT_I) VM_JUMP(!(B.i > C.i));
+        VM_CASE(JNGE_I) VM_JUMP(!(B.i >= C.i));
+        VM_CASE(JNEQ_F) VM_JUMP(!(B.f == C.f));
+        VM_CASE(JNNE_F) VM_JUMP(!(B.f != C.f));
+        VM_CASE(JNLT_F) VM_JUMP(!(B.f < C.f));
+        VM_CASE(JNLE_F) VM_JUMP(!(B.f <= C.f));
+        VM_CASE(JNGT_F) VM_JUMP(!(B.f > C.f));
+        VM_CASE(JNGE_F) VM_JUMP(!(B.f >= C.f));
+
+        VM_CASE(NOT)   A = boolValue(!B.b); VM_NEXT();
+        VM_CASE(NEG_I) A.i = (int64_t)(0 - (uint64_t)B.i); VM_NEXT();
+        VM_CASE(NEG_F) A.f = -B.f; VM_NEXT();
+        VM_CASE(I2F)   A.f = (double)B.i; VM_NEXT();
+        VM_CASE(F2I)
+            if (!(B.f >= -9223372036854775808.0 && B.f < 9223372036854775808.0)) {
+                error = "Float value out of int range";
+                goto fail;
+            }
+            A.i = (int64_t)B.f;
+            VM_NEXT();
+        VM_CASE(I2B)   A = boolValue(B.i != 0); VM_NEXT();
+        VM_CASE(F2B)   A = boolValue(B.f != 0.0); VM_NEXT();
+
+        VM_CASE(INC_I) A.i = (int64_t)((uint64_t)A.i + 1); VM_NEXT();
+        VM_CASE(DEC_I) A.i = (int64_t)((uint64_t)A.i - 1); VM_NEXT();
+        VM_CASE(INC_F) A.f += 1.0; VM_NEXT();
+        VM_CASE(DEC_F) A.f -= 1.0; VM_NEXT();
+        VM_CASE(INC_JLT_I) B.i = (int64_t)((uint64_t)B.i + 1); VM_JUMP(B.i < C.i);
+        VM_CASE(INC_JLE_I) B.i = (int64_t)((uint64_t)B.i + 1); VM_JUMP(B.i <= C.i);
+        VM_CASE(DEC_JGT_I) B.i = (int64_t)((uint64_t)B.i - 1); VM_JUMP(B.i > C.i);
+        VM_CASE(DEC_JGE_I) B.i = (int64_t)((uint64_t)B.i - 1); VM_JUMP(B.i >= C.i);
+
+        VM_CASE(READ_I)
+            if (!input.readInt(A.i)) {
+                error = "Expected int input for " + bytecode.slotNames[ip->a];
+                goto fail;
+            }
+            VM_NEXT();
+        VM_CASE(READ_F)
+            if (!input.readFloat(A.f)) {
+                error = "Expected float input for " + bytecode.slotNames[ip->a];
+                goto fail;
+            }
+            VM_NEXT();
+        VM_CASE(READ_B)
+            A.i = 0;
+            if (!input.readBool(A.b)) {
+                error = "Expected bool input for " + bytecode.slotNames[ip->a];
+                goto fail;
+            }
+            VM_NEXT();
+        VM_CASE(WRITE_I) output.writeInt(A.i); VM_NEXT();
+        VM_CASE(WRITE_F) output.writeFloat(A.f); VM_NEXT();
+        VM_CASE(WRITE_B) output.writeBool(A.b); VM_NEXT();
+        VM_CASE(PUTC)    output.put((char)ip->a); VM_NEXT();
+#if !VM_THREADED
+            default:
+                error = "Bad instruction";
+                goto fail;
+            }
+#endif
+        }
+
+#undef VM_CASE
+#undef VM_DISPATCH
+#undef VM_NEXT
+#undef VM_JUMP
+#undef A
+#undef B
+#undef C
+
+    fail:
+        output.flush();
+        return false;
+    }
+
+    // 变量的当前值（调试和对照用）
+    Value slot(uint32_t index) const {
+        return registers[index];
+    }
+};
+
+#endif // VM_H